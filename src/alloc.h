@@ -0,0 +1,46 @@
+#ifndef __ALLOC_H__
+#define __ALLOC_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "stack.h"
+
+// Aiguillage entre un allocateur personnalise et la libc (allocator NULL)
+
+static inline void* stack_mem_alloc(const stack_allocator_t* allocator, size_t bytes){
+    return allocator ? allocator->alloc(allocator->ctx, bytes) : malloc(bytes);
+}
+
+static inline void* stack_mem_calloc(const stack_allocator_t* allocator, size_t count, size_t size){
+    if (!allocator) return calloc(count, size);
+    if (size && count > SIZE_MAX / size) return NULL;
+
+    void *ptr = allocator->alloc(allocator->ctx, count * size);
+    if (ptr) memset(ptr, 0, count * size);
+    return ptr;
+}
+
+// Alloue bytes octets alignes sur alignment (puissance de 2) en sur-allouant alignment - 1 octets
+// *raw recoit l'adresse renvoyee par l'allocateur, c'est elle qu'il faut passer a stack_mem_free
+static inline void* stack_mem_alloc_aligned(const stack_allocator_t* allocator, size_t bytes, size_t alignment, void** raw){
+    if (bytes > SIZE_MAX - (alignment - 1)) return (*raw = NULL);
+
+    *raw = stack_mem_alloc(allocator, bytes + alignment - 1);
+    if (!*raw) return NULL;
+
+    return (void*)(((uintptr_t)*raw + alignment - 1) & ~(uintptr_t)(alignment - 1));
+}
+
+static inline void* stack_mem_realloc(const stack_allocator_t* allocator, void* ptr, size_t bytes){
+    return allocator ? allocator->realloc(allocator->ctx, ptr, bytes) : realloc(ptr, bytes);
+}
+
+static inline void stack_mem_free(const stack_allocator_t* allocator, void* ptr){
+    if (!ptr) return;
+    if (allocator) allocator->free(allocator->ctx, ptr);
+    else free(ptr);
+}
+
+#endif // __ALLOC_H__
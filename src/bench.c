@@ -0,0 +1,291 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "stack.h"
+
+// Benchmarks de la bibliotheque, sortie CSV (une ligne par mesure) :
+// case,impl,elem_size,ops,seconds,mops_per_sec,ns_per_op,p50_ns,p99_ns,p999_ns
+//
+// - push / peek / pop : debit par type de pile et par taille d'element (1 o a 4 Ko)
+// - mixed : suite pseudo-aleatoire de push (60%) et pop (40%)
+// - latency_push / latency_pop : percentiles de la latence de chaque operation
+//   (mesuree avec clock_gettime, le cout de la mesure est inclus : voir la ligne latency_clock)
+// - l'implementation "array" est un tableau C brut (memcpy + index), la reference a atteindre
+// - l'implementation "mapped" travaille dans un fichier temporaire de BENCH_MAPPED_PATH
+// - l'implementation "fixed_prefault" est une pile fixe dont les pages sont touchees a la creation
+// - l'implementation "reserved" est une pile extensible dans une plage d'adresses reservee (sans realloc)
+// - create_destroy : cycle creation + un push + destruction d'une petite pile (64 elements de 8 o)
+// - init_in : le meme cycle pour une pile fixe creee dans une zone de la pile d'appel (stack_init_in, sans allocation)
+
+#define MAX_BYTES (64u << 20)
+#define MAX_OPS (1u << 20)
+#define LATENCY_OPS (1u << 16)
+#define LIFECYCLE_OPS (1u << 20)
+#define LIFECYCLE_LENGTH 64
+#define BENCH_MAPPED_PATH "/tmp/stack_bench.mstack"
+
+static const size_t elem_sizes[] = {1, 2, 4, 8, 16, 32, 64, 256, 1024, 4096};
+
+typedef enum {
+    IMPL_ARRAY,
+    IMPL_FIXED,
+    IMPL_FIXED_PREFAULT,
+    IMPL_DYNAMIC,
+    IMPL_GROWABLE,
+    IMPL_MAPPED,
+    IMPL_RESERVED,
+} impl_t;
+
+static const char *impl_names[] = {"array", "fixed", "fixed_prefault", "dynamic", "growable", "mapped", "reserved"};
+
+// Le tableau brut de reference, meme semantique qu'une pile fixe sans verification
+typedef struct {
+    char *data;
+    size_t top;
+    size_t size;
+} array_t;
+
+typedef struct {
+    impl_t impl;
+    stack_t *stack;
+    array_t array;
+} bench_stack_t;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bench_stack_t bench_create(impl_t impl, size_t size, size_t ops) {
+    bench_stack_t b = {.impl = impl};
+
+    switch (impl) {
+    case IMPL_ARRAY:
+        b.array = (array_t){.data = calloc(ops, size), .size = size};
+        break;
+    case IMPL_FIXED:
+        b.stack = stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.length = ops, .size = size});
+        break;
+    case IMPL_FIXED_PREFAULT:
+        b.stack = stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.length = ops, .size = size, .prefault = true});
+        break;
+    case IMPL_DYNAMIC:
+        b.stack = stack_create(STACK_TYPE_DYNAMIC, &(dstack_config_t){.size = size});
+        break;
+    case IMPL_GROWABLE:
+        b.stack = stack_create(STACK_TYPE_GROWABLE, &(gstack_config_t){.size = size});
+        break;
+    case IMPL_MAPPED:
+        remove(BENCH_MAPPED_PATH);
+        b.stack = stack_create(STACK_TYPE_MAPPED, &(mstack_config_t){.path = BENCH_MAPPED_PATH, .size = size});
+        break;
+    case IMPL_RESERVED:
+        b.stack = stack_create(STACK_TYPE_RESERVED, &(rstack_config_t){.size = size, .max_length = ops});
+        break;
+    }
+
+    return b;
+}
+
+static void bench_destroy(bench_stack_t *b) {
+    if (b->impl == IMPL_ARRAY) free(b->array.data);
+    else stack_destroy(&b->stack);
+
+    if (b->impl == IMPL_MAPPED) remove(BENCH_MAPPED_PATH);
+}
+
+static inline void bench_push(bench_stack_t *b, void *val) {
+    if (b->impl == IMPL_ARRAY) {
+        memcpy(b->array.data + b->array.top++ * b->array.size, val, b->array.size);
+        return;
+    }
+    stack_push(b->stack, val);
+}
+
+static inline void *bench_peek(bench_stack_t *b) {
+    if (b->impl == IMPL_ARRAY)
+        return b->array.top ? b->array.data + (b->array.top - 1) * b->array.size : NULL;
+    return stack_peek(b->stack);
+}
+
+static inline void *bench_pop(bench_stack_t *b, void *popped) {
+    if (b->impl == IMPL_ARRAY) {
+        if (!b->array.top) return NULL;
+        memcpy(popped, b->array.data + --b->array.top * b->array.size, b->array.size);
+        return popped;
+    }
+    return stack_pop(b->stack, popped);
+}
+
+// Empeche le compilateur de supprimer les lectures
+static volatile unsigned char sink;
+
+static void report(const char *name, impl_t impl, size_t size, size_t ops, double seconds) {
+    printf("%s,%s,%zu,%zu,%f,%f,%f,,,\n", name, impl_names[impl], size, ops, seconds,
+           ops / seconds / 1e6, seconds * 1e9 / ops);
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void report_latency(const char *name, impl_t impl, size_t size, double *samples, size_t n) {
+    double total = 0;
+    for (size_t i = 0; i < n; i++) total += samples[i];
+
+    qsort(samples, n, sizeof(*samples), cmp_double);
+    printf("%s,%s,%zu,%zu,%f,%f,%f,%f,%f,%f\n", name, impl_names[impl], size, n, total,
+           n / total / 1e6, total * 1e9 / n,
+           samples[n / 2] * 1e9, samples[n * 99 / 100] * 1e9, samples[n * 999 / 1000] * 1e9);
+}
+
+static void bench_throughput(impl_t impl, size_t size) {
+    size_t ops = MAX_BYTES / size < MAX_OPS ? MAX_BYTES / size : MAX_OPS;
+    char *val = calloc(1, size);
+    bench_stack_t b = bench_create(impl, size, ops);
+
+    double start = now();
+    for (size_t i = 0; i < ops; i++) {
+        val[0] = (char)i;
+        bench_push(&b, val);
+    }
+    report("push", impl, size, ops, now() - start);
+
+    start = now();
+    for (size_t i = 0; i < ops; i++)
+        sink = *(unsigned char *)bench_peek(&b);
+    report("peek", impl, size, ops, now() - start);
+
+    start = now();
+    for (size_t i = 0; i < ops; i++)
+        bench_pop(&b, val);
+    report("pop", impl, size, ops, now() - start);
+
+    bench_destroy(&b);
+    free(val);
+}
+
+static void bench_mixed(impl_t impl, size_t size) {
+    size_t ops = MAX_BYTES / size < MAX_OPS ? MAX_BYTES / size : MAX_OPS;
+    char *val = calloc(1, size);
+    bench_stack_t b = bench_create(impl, size, ops);
+
+    uint32_t seed = 12345;
+    double start = now();
+    for (size_t i = 0; i < ops; i++) {
+        seed = seed * 1103515245u + 12345u;
+        if ((seed >> 16) % 10 < 6 || !bench_peek(&b)) bench_push(&b, val);
+        else bench_pop(&b, val);
+    }
+    report("mixed", impl, size, ops, now() - start);
+
+    bench_destroy(&b);
+    free(val);
+}
+
+static void bench_latency(impl_t impl, size_t size) {
+    size_t ops = MAX_BYTES / size < LATENCY_OPS ? MAX_BYTES / size : LATENCY_OPS;
+    char *val = calloc(1, size);
+    double *samples = malloc(ops * sizeof(*samples));
+    bench_stack_t b = bench_create(impl, size, ops);
+
+    for (size_t i = 0; i < ops; i++) {
+        double start = now();
+        bench_push(&b, val);
+        samples[i] = now() - start;
+    }
+    report_latency("latency_push", impl, size, samples, ops);
+
+    for (size_t i = 0; i < ops; i++) {
+        double start = now();
+        bench_pop(&b, val);
+        samples[i] = now() - start;
+    }
+    report_latency("latency_pop", impl, size, samples, ops);
+
+    bench_destroy(&b);
+    free(samples);
+    free(val);
+}
+
+//Le cout d'une mesure vide, a soustraire des percentiles de latence
+static void bench_clock(void) {
+    double *samples = malloc(LATENCY_OPS * sizeof(*samples));
+
+    for (size_t i = 0; i < LATENCY_OPS; i++) {
+        double start = now();
+        samples[i] = now() - start;
+    }
+
+    qsort(samples, LATENCY_OPS, sizeof(*samples), cmp_double);
+    printf("latency_clock,none,0,%u,,,,%f,%f,%f\n", LATENCY_OPS,
+           samples[LATENCY_OPS / 2] * 1e9, samples[LATENCY_OPS * 99 / 100] * 1e9, samples[LATENCY_OPS * 999 / 1000] * 1e9);
+
+    free(samples);
+}
+
+//Cout d'une pile de courte duree : creation, un push, destruction
+static void bench_lifecycle(void) {
+    uint64_t val = 1;
+    fstack_config_t fconfig = {.size = sizeof(val), .length = LIFECYCLE_LENGTH};
+    dstack_config_t dconfig = {.size = sizeof(val), .chunk_length = LIFECYCLE_LENGTH};
+    gstack_config_t gconfig = {.size = sizeof(val), .initial_length = LIFECYCLE_LENGTH};
+
+    double start = now();
+    for (size_t i = 0; i < LIFECYCLE_OPS; i++) {
+        stack_t *stack = stack_create(STACK_TYPE_FIXED, &fconfig);
+        stack_push(stack, &val);
+        stack_destroy(&stack);
+    }
+    report("create_destroy", IMPL_FIXED, sizeof(val), LIFECYCLE_OPS, now() - start);
+
+    start = now();
+    for (size_t i = 0; i < LIFECYCLE_OPS; i++) {
+        stack_t *stack = stack_create(STACK_TYPE_DYNAMIC, &dconfig);
+        stack_push(stack, &val);
+        stack_destroy(&stack);
+    }
+    report("create_destroy", IMPL_DYNAMIC, sizeof(val), LIFECYCLE_OPS, now() - start);
+
+    start = now();
+    for (size_t i = 0; i < LIFECYCLE_OPS; i++) {
+        stack_t *stack = stack_create(STACK_TYPE_GROWABLE, &gconfig);
+        stack_push(stack, &val);
+        stack_destroy(&stack);
+    }
+    report("create_destroy", IMPL_GROWABLE, sizeof(val), LIFECYCLE_OPS, now() - start);
+
+    _Alignas(max_align_t) unsigned char buffer[1024];
+    if (stack_init_in_bytes(STACK_TYPE_FIXED, &fconfig) > sizeof(buffer)) return;
+
+    start = now();
+    for (size_t i = 0; i < LIFECYCLE_OPS; i++) {
+        stack_t *stack = stack_init_in(buffer, sizeof(buffer), STACK_TYPE_FIXED, &fconfig);
+        stack_push(stack, &val);
+        stack_destroy(&stack);
+    }
+    report("init_in", IMPL_FIXED, sizeof(val), LIFECYCLE_OPS, now() - start);
+}
+
+int main(void) {
+    printf("case,impl,elem_size,ops,seconds,mops_per_sec,ns_per_op,p50_ns,p99_ns,p999_ns\n");
+
+    bench_clock();
+    bench_lifecycle();
+
+    for (size_t s = 0; s < sizeof(elem_sizes) / sizeof(elem_sizes[0]); s++) {
+        for (impl_t impl = IMPL_ARRAY; impl <= IMPL_RESERVED; impl++) {
+            bench_throughput(impl, elem_sizes[s]);
+            bench_mixed(impl, elem_sizes[s]);
+            bench_latency(impl, elem_sizes[s]);
+        }
+    }
+
+    return 0;
+}
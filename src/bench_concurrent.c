@@ -0,0 +1,108 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "stack.h"
+
+// Benchmark de contention : chaque thread enchaine des paires push/pop sur une pile partagee.
+// Compare la pile concurrente sans verrou (avec et sans tableau d'elimination) a une pile
+// dynamique protegee par un mutex.
+// Sortie CSV : impl,threads,ops,seconds,mops_per_sec
+
+#define OPS_PER_THREAD 200000
+#define BATCH 8
+
+typedef struct {
+    stack_t *stack;
+    pthread_mutex_t *lock;  // NULL = pas de verrou (pile concurrente)
+    size_t ops;
+} worker_args_t;
+
+static void locked_push(worker_args_t *args, size_t *val) {
+    if (args->lock) pthread_mutex_lock(args->lock);
+    stack_push(args->stack, val);
+    if (args->lock) pthread_mutex_unlock(args->lock);
+}
+
+static void locked_pop(worker_args_t *args, size_t *val) {
+    if (args->lock) pthread_mutex_lock(args->lock);
+    stack_pop(args->stack, val);
+    if (args->lock) pthread_mutex_unlock(args->lock);
+}
+
+static void *worker(void *arg) {
+    worker_args_t *args = arg;
+    size_t val = 0;
+
+    // on pousse BATCH elements puis on en retire BATCH, pour que la pile ne soit jamais vide
+    for (size_t i = 0; i < args->ops; i += 2 * BATCH) {
+        for (size_t b = 0; b < BATCH; b++) {
+            val = i + b;
+            locked_push(args, &val);
+        }
+        for (size_t b = 0; b < BATCH; b++) {
+            locked_pop(args, &val);
+        }
+    }
+
+    return NULL;
+}
+
+static double run(stack_t *stack, pthread_mutex_t *lock, size_t threads) {
+    pthread_t tids[threads];
+    worker_args_t args = {.stack = stack, .lock = lock, .ops = OPS_PER_THREAD};
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (size_t t = 0; t < threads; t++)
+        pthread_create(&tids[t], NULL, worker, &args);
+    for (size_t t = 0; t < threads; t++)
+        pthread_join(tids[t], NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+static void report(const char *impl, size_t threads, double seconds) {
+    size_t ops = threads * OPS_PER_THREAD;
+    printf("%s,%zu,%zu,%f,%f\n", impl, threads, ops, seconds, ops / seconds / 1e6);
+}
+
+int main(int argc, char **argv) {
+    size_t max_threads = argc > 1 ? strtoul(argv[1], NULL, 10) : 64;
+
+    printf("impl,threads,ops,seconds,mops_per_sec\n");
+
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        stack_t *cstack = stack_create(STACK_TYPE_CONCURRENT, &(cstack_config_t){.size = sizeof(size_t)});
+        report("concurrent", threads, run(cstack, NULL, threads));
+        stack_destroy(&cstack);
+
+        stack_t *elim = stack_create(STACK_TYPE_CONCURRENT, &(cstack_config_t){
+            .size = sizeof(size_t),
+            .elimination_slots = 16
+        });
+        report("concurrent_elimination", threads, run(elim, NULL, threads));
+        stack_destroy(&elim);
+
+        stack_t *adaptive = stack_create(STACK_TYPE_CONCURRENT, &(cstack_config_t){
+            .size = sizeof(size_t),
+            .elimination_slots = 16,
+            .elimination_adaptive = true
+        });
+        report("concurrent_elimination_adaptive", threads, run(adaptive, NULL, threads));
+        stack_destroy(&adaptive);
+
+        pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+        stack_t *dstack = stack_create(STACK_TYPE_DYNAMIC, &(dstack_config_t){.size = sizeof(size_t)});
+        report("dynamic_mutex", threads, run(dstack, &lock, threads));
+        stack_destroy(&dstack);
+        pthread_mutex_destroy(&lock);
+    }
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "stack.h"
+
+// Exemple d'ordonnanceur fork-join sur des piles a vol de travail : fibonacci parallele.
+// Chaque worker a sa propre pile de taches (STACK_TYPE_WORK_STEALING). Une tache fib(n) pousse
+// fib(n-1) sur la pile de son worker, calcule fib(n-2) elle-meme puis recupere fib(n-1) :
+// soit en le retirant de sa pile (il n'a pas ete vole), soit en attendant qu'un voleur le termine,
+// en volant d'autres taches pendant l'attente.
+// Sortie CSV : workers,n,seconds,speedup,tasks,steals,steal_attempts
+
+#define FIB_N 38
+#define FIB_CUTOFF 18
+
+typedef struct _task_t {
+    int n;
+    long result;
+    _Atomic bool done;
+} task_t;
+
+typedef struct _worker_t {
+    stack_t *tasks;
+    size_t id;
+    size_t tasks_run;
+    size_t steals;
+    size_t steal_attempts;
+    uint32_t seed;
+    pthread_t thread;
+} worker_t;
+
+static worker_t *workers;
+static size_t worker_count;
+static _Atomic bool finished;
+
+static long fib_seq(int n) {
+    return n < 2 ? n : fib_seq(n - 1) + fib_seq(n - 2);
+}
+
+static void run_task(worker_t *self, task_t *task);
+
+//Vole une tache chez un worker pris au hasard et l'execute
+static bool steal_and_run(worker_t *self) {
+    if (worker_count < 2) return false;
+
+    self->seed ^= self->seed << 13;
+    self->seed ^= self->seed >> 17;
+    self->seed ^= self->seed << 5;
+
+    size_t victim = self->seed % (worker_count - 1);
+    if (victim >= self->id) victim++;
+
+    task_t *task;
+    self->steal_attempts++;
+    if (!stack_steal(workers[victim].tasks, &task)) return false;
+
+    self->steals++;
+    run_task(self, task);
+    return true;
+}
+
+static void run_task(worker_t *self, task_t *task) {
+    self->tasks_run++;
+
+    if (task->n < FIB_CUTOFF) {
+        task->result = fib_seq(task->n);
+        atomic_store_explicit(&task->done, true, memory_order_release);
+        return;
+    }
+
+    task_t child = {.n = task->n - 1, .result = 0};
+    atomic_init(&child.done, false);
+
+    task_t *child_ptr = &child;
+    stack_push(self->tasks, &child_ptr);
+
+    task_t sibling = {.n = task->n - 2, .result = 0};
+    atomic_init(&sibling.done, false);
+    run_task(self, &sibling);
+
+    // tout ce qui a ete pousse apres child a deja ete retire : le sommet est child, sauf s'il a ete vole
+    task_t *popped;
+    if (stack_pop(self->tasks, &popped)) {
+        run_task(self, popped);
+    } else {
+        while (!atomic_load_explicit(&child.done, memory_order_acquire)) {
+            if (!steal_and_run(self)) sched_yield();
+        }
+    }
+
+    task->result = child.result + sibling.result;
+    atomic_store_explicit(&task->done, true, memory_order_release);
+}
+
+static void *worker_loop(void *arg) {
+    worker_t *self = arg;
+
+    while (!atomic_load_explicit(&finished, memory_order_acquire)) {
+        if (!steal_and_run(self)) sched_yield();
+    }
+
+    return NULL;
+}
+
+static double run(size_t count, long *result, size_t *tasks, size_t *steals, size_t *attempts) {
+    worker_count = count;
+    workers = calloc(count, sizeof(*workers));
+    atomic_store(&finished, false);
+
+    for (size_t i = 0; i < count; i++) {
+        workers[i].id = i;
+        workers[i].seed = (uint32_t)(2654435761u * (i + 1));
+        workers[i].tasks = stack_create(STACK_TYPE_WORK_STEALING, &(wstack_config_t){.size = sizeof(task_t *)});
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // le thread principal est le worker 0 et execute la tache racine
+    for (size_t i = 1; i < count; i++)
+        pthread_create(&workers[i].thread, NULL, worker_loop, &workers[i]);
+
+    task_t root = {.n = FIB_N, .result = 0};
+    atomic_init(&root.done, false);
+    run_task(&workers[0], &root);
+
+    atomic_store_explicit(&finished, true, memory_order_release);
+    for (size_t i = 1; i < count; i++)
+        pthread_join(workers[i].thread, NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    *result = root.result;
+    *tasks = *steals = *attempts = 0;
+    for (size_t i = 0; i < count; i++) {
+        *tasks += workers[i].tasks_run;
+        *steals += workers[i].steals;
+        *attempts += workers[i].steal_attempts;
+        stack_destroy(&workers[i].tasks);
+    }
+    free(workers);
+
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+int main(int argc, char **argv) {
+    size_t max_workers = argc > 1 ? strtoul(argv[1], NULL, 10) : 8;
+    double baseline = 0;
+    long expected = fib_seq(FIB_N);
+
+    printf("workers,n,seconds,speedup,tasks,steals,steal_attempts\n");
+
+    for (size_t count = 1; count <= max_workers; count *= 2) {
+        long result;
+        size_t tasks, steals, attempts;
+        double seconds = run(count, &result, &tasks, &steals, &attempts);
+
+        if (result != expected) {
+            fprintf(stderr, "[!] bench_fib : wrong result with %zu workers : %ld != %ld\n", count, result, expected);
+            return 1;
+        }
+
+        if (count == 1) baseline = seconds;
+        printf("%zu,%d,%f,%f,%zu,%zu,%zu\n", count, FIB_N, seconds, baseline / seconds, tasks, steals, attempts);
+    }
+
+    return 0;
+}
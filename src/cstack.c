@@ -0,0 +1,513 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "stack.h"
+#include "cstack.h"
+#include "alloc.h"
+#include "stats.h"
+#include "wait.h"
+
+// Pile de Treiber : push et pop sont un CAS sur le mot top.
+//
+// Le probleme ABA est evite par un tag incremente a chaque CAS, stocke a cote de l'index du noeud
+// dans un seul mot de 64 bits (CAS simple, pas besoin de CAS 128 bits).
+// Les noeuds ne sont jamais rendus a l'allocateur pendant la vie de la pile : un noeud retire
+// retourne dans une liste libre (elle aussi une pile de Treiber taggee). Un thread qui lit le next
+// d'un noeud deja retire et recycle lit donc toujours de la memoire valide, et son CAS echoue
+// grace au tag.
+//
+// Elimination : lorsqu'un CAS sur le sommet echoue (contention), un push offre son noeud dans une
+// case aleatoire du tableau d'elimination et attend quelques iterations. Un pop qui echoue son CAS
+// regarde une case aleatoire et prend le noeud offert s'il y en a un. Les deux operations se
+// compensent sans toucher au sommet. En mode adaptatif, le nombre de cases utilisees diminue quand
+// les offres expirent et augmente quand les cases sont deja occupees.
+//
+// Attente (stack_pop_wait / stack_push_wait) : un thread qui trouve la pile vide (ou pleine) essaie encore
+// CSTACK_WAIT_SPINS fois, puis s'inscrit dans pop_waiters (push_waiters), relit pop_seq (push_seq), verifie une
+// derniere fois la pile et s'endort sur pop_seq avec un futex. Un push qui reussit lit pop_waiters : s'il vaut 0
+// (cas courant), rien d'autre n'est fait ; sinon il incremente pop_seq et reveille un thread. L'inscription et la
+// verification d'un cote, le CAS sur le sommet et la lecture de pop_waiters de l'autre sont seq_cst : soit le push
+// voit le thread inscrit, soit le thread voit l'element, aucun reveil n'est perdu.
+
+#define NODE_HEADER_SIZE ((sizeof(cnode_t) + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1))
+
+#define REF_INDEX(ref) ((uint32_t)(ref))
+#define REF_TAG(ref) ((ref) >> 32)
+#define REF_MAKE(tag, index) (((cstack_ref_t)(tag) << 32) | (uint32_t)(index))
+
+// Nombre de tentatives d'un pop (push) en attente avant de s'endormir
+#define CSTACK_WAIT_SPINS 64
+
+static void cstack_destroy(stack_t** stack_ptr);
+static stack_error_t cstack_push(stack_t* stack, void* val);
+static void* cstack_peek(stack_t* stack);
+static stack_error_t cstack_pop(stack_t* stack, void* popped);
+static bool cstack_is_empty(stack_t* stack);
+static stack_error_t cstack_pop_wait(stack_t* stack, void* popped, long timeout_ms);
+static stack_error_t cstack_push_wait(stack_t* stack, void* val, long timeout_ms);
+static void cstack_close(stack_t* stack);
+static void cstack_list_push(cstack_t* cstack, _Atomic cstack_ref_t* list, uint32_t first, uint32_t last);
+static uint32_t cstack_grow(cstack_t* cstack, stack_error_t* err);
+
+typedef enum {
+    TRY_OK,
+    TRY_EMPTY,
+    TRY_CONTENDED,
+} try_result_t;
+
+int cstack_init(cstack_t* stack, cstack_config_t config){
+    if (!stack) return (fprintf(stderr, "[!] cstack_init : invalid stack pointer\n"), -1);
+    if (config.size == 0) return (fprintf(stderr, "[!] cstack_init : invalid config size : size must be > 0\n"), -1);
+
+    size_t first_length = 1;
+    size_t wanted = config.initial_length ? config.initial_length : CSTACK_DEFAULT_INITIAL_LENGTH;
+    while (first_length < wanted && first_length < UINT32_MAX / 2) first_length <<= 1;
+
+    if (config.size > SIZE_MAX / 2 - NODE_HEADER_SIZE)
+        return (fprintf(stderr, "[!] cstack_init : invalid config size : size is too large\n"), -1);
+    if (config.max_length > UINT32_MAX / 2)
+        return (fprintf(stderr, "[!] cstack_init : invalid config max_length : max_length is too large\n"), -1);
+    if (config.elimination_slots > SIZE_MAX / sizeof(cslot_t))
+        return (fprintf(stderr, "[!] cstack_init : invalid config elimination_slots : elimination_slots is too large\n"), -1);
+
+    memset(stack, 0, sizeof(*stack));
+    stack->raw = stack;
+
+    stack->base = (stack_t){
+        .type = STACK_TYPE_CONCURRENT,
+        .size = config.size,
+        .allocator = config.allocator,
+        .destroy = cstack_destroy,
+        .push = cstack_push,
+        .peek = cstack_peek,
+        .pop = cstack_pop,
+        .is_empty = cstack_is_empty,
+        .pop_wait = cstack_pop_wait,
+        .push_wait = cstack_push_wait,
+        .close = cstack_close
+    };
+
+    atomic_init(&stack->top, 0);
+    atomic_init(&stack->free_list, 0);
+    for (size_t k = 0; k < CSTACK_MAX_SEGMENTS; k++)
+        atomic_init(&stack->segments[k], NULL);
+
+    stack->first_length = first_length;
+    stack->node_stride = (NODE_HEADER_SIZE + config.size + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1);
+
+    if (config.elimination_slots){
+        stack->slots = stack_mem_alloc_aligned(config.allocator, config.elimination_slots * sizeof(cslot_t), CSTACK_CACHE_LINE, &stack->slots_raw);
+        if (!stack->slots) return (perror("malloc failed"), -1);
+        STACK_STATS_ALLOC(stack, config.elimination_slots * sizeof(cslot_t));
+
+        for (size_t i = 0; i < config.elimination_slots; i++)
+            atomic_init(&stack->slots[i].value, 0);
+    }
+
+    stack->slot_count = config.elimination_slots;
+    atomic_init(&stack->slot_range, config.elimination_adaptive ? 1 : config.elimination_slots);
+    stack->adaptive = config.elimination_adaptive;
+    stack->spins = config.elimination_spins ? config.elimination_spins : CSTACK_DEFAULT_ELIMINATION_SPINS;
+
+    stack->max_length = config.max_length;
+    atomic_init(&stack->length, 0);
+    atomic_init(&stack->closed, false);
+    atomic_init(&stack->pop_seq, 0);
+    atomic_init(&stack->pop_waiters, 0);
+    atomic_init(&stack->push_seq, 0);
+    atomic_init(&stack->push_waiters, 0);
+
+    //prealloue le premier segment : tous ses noeuds vont dans la liste libre
+    stack_error_t err = STACK_OK;
+    uint32_t ref = cstack_grow(stack, &err);
+    if (!ref){
+        fprintf(stderr, "[!] cstack_init : %s\n", stack_strerror(err));
+        stack_mem_free(config.allocator, stack->slots_raw);
+        return -1;
+    }
+    cstack_list_push(stack, &stack->free_list, ref - 1, ref - 1);
+
+    return 0;
+}
+
+static void cstack_destroy(stack_t** stack_ptr){
+    assert(stack_ptr && *stack_ptr);
+    cstack_t *stack = (cstack_t*)*stack_ptr;
+
+    for (size_t k = 0; k < CSTACK_MAX_SEGMENTS; k++)
+        stack_mem_free(stack->base.allocator, atomic_load_explicit(&stack->segments[k], memory_order_relaxed));
+
+    stack_mem_free(stack->base.allocator, stack->slots_raw);
+    stack_mem_free(stack->base.allocator, stack->raw);
+    *stack_ptr = NULL;
+}
+
+//Le noeud d'index index (index global, les segments se suivent)
+static cnode_t* cstack_node(cstack_t* cstack, uint32_t index){
+    unsigned long long q = index / cstack->first_length + 1;
+#if defined(__GNUC__)
+    size_t k = 63 - __builtin_clzll(q);
+#else
+    size_t k = 0;
+    while (q >>= 1) k++;
+#endif
+
+    size_t offset = index - cstack->first_length * (((size_t)1 << k) - 1);
+    char *segment = atomic_load_explicit(&cstack->segments[k], memory_order_acquire);
+
+    return (cnode_t*)(segment + offset * cstack->node_stride);
+}
+
+static void* cstack_node_data(cnode_t* node){
+    return (char*)node + NODE_HEADER_SIZE;
+}
+
+//Ajoute la chaine de noeuds first..last (deja liee) en tete de la liste list
+//Le CAS est seq_cst : sur le sommet, il doit preceder la lecture de pop_waiters (voir cstack_wake)
+static void cstack_list_push(cstack_t* cstack, _Atomic cstack_ref_t* list, uint32_t first, uint32_t last){
+    cnode_t *last_node = cstack_node(cstack, last);
+    cstack_ref_t old = atomic_load_explicit(list, memory_order_relaxed);
+    cstack_ref_t new;
+
+    do {
+        atomic_store_explicit(&last_node->next, REF_INDEX(old), memory_order_relaxed);
+        new = REF_MAKE(REF_TAG(old) + 1, first + 1);
+    } while (!atomic_compare_exchange_weak_explicit(list, &old, new, memory_order_seq_cst, memory_order_relaxed));
+}
+
+//Retire le noeud en tete de la liste list, retourne son index + 1 (0 si la liste est vide)
+static uint32_t cstack_list_pop(cstack_t* cstack, _Atomic cstack_ref_t* list){
+    cstack_ref_t old = atomic_load_explicit(list, memory_order_acquire);
+    cstack_ref_t new;
+
+    do {
+        if (REF_INDEX(old) == 0) return 0;
+
+        //le noeud peut avoir ete retire et recycle entre-temps : la lecture reste valide et le CAS echouera
+        cnode_t *node = cstack_node(cstack, REF_INDEX(old) - 1);
+        new = REF_MAKE(REF_TAG(old) + 1, atomic_load_explicit(&node->next, memory_order_relaxed));
+    } while (!atomic_compare_exchange_weak_explicit(list, &old, new, memory_order_acquire, memory_order_acquire));
+
+    return REF_INDEX(old);
+}
+
+//Une seule tentative d'ajout du noeud index au sommet
+static bool cstack_try_push(cstack_t* cstack, uint32_t index){
+    cnode_t *node = cstack_node(cstack, index);
+    cstack_ref_t old = atomic_load_explicit(&cstack->top, memory_order_relaxed);
+
+    atomic_store_explicit(&node->next, REF_INDEX(old), memory_order_relaxed);
+    return atomic_compare_exchange_strong_explicit(&cstack->top, &old, REF_MAKE(REF_TAG(old) + 1, index + 1), memory_order_seq_cst, memory_order_relaxed);
+}
+
+//Une seule tentative de retrait du sommet, ref recoit l'index + 1 du noeud retire
+static try_result_t cstack_try_pop(cstack_t* cstack, uint32_t* ref){
+    cstack_ref_t old = atomic_load_explicit(&cstack->top, memory_order_acquire);
+    if (REF_INDEX(old) == 0) return TRY_EMPTY;
+
+    cnode_t *node = cstack_node(cstack, REF_INDEX(old) - 1);
+    cstack_ref_t new = REF_MAKE(REF_TAG(old) + 1, atomic_load_explicit(&node->next, memory_order_relaxed));
+
+    if (!atomic_compare_exchange_strong_explicit(&cstack->top, &old, new, memory_order_acquire, memory_order_relaxed))
+        return TRY_CONTENDED;
+
+    *ref = REF_INDEX(old);
+    return TRY_OK;
+}
+
+//Generateur pseudo-aleatoire par thread (xorshift) pour choisir une case
+static size_t cstack_random_slot(cstack_t* cstack){
+    static _Thread_local uint32_t state = 0;
+    if (!state) state = (uint32_t)(uintptr_t)&state | 1;
+
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+
+    size_t range = atomic_load_explicit(&cstack->slot_range, memory_order_relaxed);
+    return state % range;
+}
+
+//Ajuste le nombre de cases utilisees : delta = +1 (cases occupees) ou -1 (offre expiree)
+static void cstack_adapt_range(cstack_t* cstack, int delta){
+    if (!cstack->adaptive) return;
+
+    size_t range = atomic_load_explicit(&cstack->slot_range, memory_order_relaxed);
+    if (delta > 0 && range < cstack->slot_count)
+        atomic_compare_exchange_weak_explicit(&cstack->slot_range, &range, range + 1, memory_order_relaxed, memory_order_relaxed);
+    else if (delta < 0 && range > 1)
+        atomic_compare_exchange_weak_explicit(&cstack->slot_range, &range, range - 1, memory_order_relaxed, memory_order_relaxed);
+}
+
+//Offre le noeud index dans une case, retourne true si un pop l'a pris
+static bool cstack_eliminate_push(cstack_t* cstack, uint32_t index){
+    cslot_t *slot = &cstack->slots[cstack_random_slot(cstack)];
+    cstack_ref_t empty = atomic_load_explicit(&slot->value, memory_order_relaxed);
+
+    if (REF_INDEX(empty) != 0){
+        cstack_adapt_range(cstack, +1);
+        return false;
+    }
+
+    cstack_ref_t offer = REF_MAKE(REF_TAG(empty) + 1, index + 1);
+    if (!atomic_compare_exchange_strong_explicit(&slot->value, &empty, offer, memory_order_release, memory_order_relaxed)){
+        cstack_adapt_range(cstack, +1);
+        return false;
+    }
+
+    for (size_t i = 0; i < cstack->spins; i++){
+        if (atomic_load_explicit(&slot->value, memory_order_relaxed) != offer)
+            return true;
+    }
+
+    //personne n'a pris l'offre : on la retire, si le CAS echoue c'est qu'un pop l'a prise entre-temps
+    cstack_ref_t expected = offer;
+    if (atomic_compare_exchange_strong_explicit(&slot->value, &expected, REF_MAKE(REF_TAG(offer) + 1, 0), memory_order_relaxed, memory_order_relaxed)){
+        cstack_adapt_range(cstack, -1);
+        return false;
+    }
+
+    return true;
+}
+
+//Prend le noeud offert dans une case s'il y en a un, ref recoit son index + 1
+static bool cstack_eliminate_pop(cstack_t* cstack, uint32_t* ref){
+    cslot_t *slot = &cstack->slots[cstack_random_slot(cstack)];
+    cstack_ref_t offer = atomic_load_explicit(&slot->value, memory_order_acquire);
+
+    if (REF_INDEX(offer) == 0) return false;
+
+    if (!atomic_compare_exchange_strong_explicit(&slot->value, &offer, REF_MAKE(REF_TAG(offer) + 1, 0), memory_order_acquire, memory_order_relaxed)){
+        cstack_adapt_range(cstack, +1);
+        return false;
+    }
+
+    *ref = REF_INDEX(offer);
+    return true;
+}
+
+//Alloue le segment suivant, garde son premier noeud et donne les autres a la liste libre
+//Retourne l'index + 1 du noeud garde (0 si la pile est pleine ou si l'allocation echoue, la cause est dans err)
+static uint32_t cstack_grow(cstack_t* cstack, stack_error_t* err){
+    for (size_t k = 0; k < CSTACK_MAX_SEGMENTS; k++){
+        if (atomic_load_explicit(&cstack->segments[k], memory_order_acquire)) continue;
+
+        size_t base = cstack->first_length * (((size_t)1 << k) - 1);
+        size_t length = cstack->first_length << k;
+        if (base + length > UINT32_MAX) break;
+
+        char *segment = stack_mem_alloc(cstack->base.allocator, length * cstack->node_stride);
+        if (!segment) return (*err = STACK_ERR_NO_MEMORY, 0);
+        STACK_STATS_ALLOC(cstack, length * cstack->node_stride);
+
+        char *expected = NULL;
+        if (!atomic_compare_exchange_strong_explicit(&cstack->segments[k], &expected, segment, memory_order_acq_rel, memory_order_acquire)){
+            //un autre thread a ajoute ce segment avant nous, ses noeuds sont dans la liste libre
+            stack_mem_free(cstack->base.allocator, segment);
+            STACK_STATS_FREE(cstack, length * cstack->node_stride);
+            uint32_t ref = cstack_list_pop(cstack, &cstack->free_list);
+            if (ref) return ref;
+            continue;
+        }
+
+        if (length > 1){
+            for (size_t i = 1; i < length - 1; i++){
+                cnode_t *node = (cnode_t*)(segment + i * cstack->node_stride);
+                atomic_init(&node->next, (uint32_t)(base + i + 2));
+            }
+            cstack_list_push(cstack, &cstack->free_list, (uint32_t)(base + 1), (uint32_t)(base + length - 1));
+        }
+
+        return (uint32_t)(base + 1);
+    }
+
+    *err = STACK_ERR_FULL;
+    return 0;
+}
+
+//Reveille un thread endormi sur seq, s'il y en a un inscrit dans waiters
+static void cstack_wake(_Atomic uint32_t* seq, _Atomic uint32_t* waiters){
+    if (atomic_load_explicit(waiters, memory_order_seq_cst) == 0) return;
+
+    atomic_fetch_add_explicit(seq, 1, memory_order_release);
+    stack_futex_wake(seq, 1);
+}
+
+//Reserve une place dans une pile bornee, retourne false si elle est pleine
+static bool cstack_reserve(cstack_t* cstack){
+    size_t length = atomic_load_explicit(&cstack->length, memory_order_relaxed);
+
+    do {
+        if (length >= cstack->max_length) return false;
+    } while (!atomic_compare_exchange_weak_explicit(&cstack->length, &length, length + 1, memory_order_relaxed, memory_order_relaxed));
+
+    return true;
+}
+
+//Rend une place dans une pile bornee et reveille un push en attente
+static void cstack_release(cstack_t* cstack){
+    atomic_fetch_sub_explicit(&cstack->length, 1, memory_order_seq_cst);
+    cstack_wake(&cstack->push_seq, &cstack->push_waiters);
+}
+
+//Ajoute val au sommet, sans compter les echecs dans les statistiques
+static stack_error_t cstack_add(cstack_t* cstack, void* val){
+    if (atomic_load_explicit(&cstack->closed, memory_order_relaxed)) return STACK_ERR_CLOSED;
+    if (cstack->max_length && !cstack_reserve(cstack)) return STACK_ERR_FULL;
+
+    stack_error_t err = STACK_OK;
+
+    uint32_t ref = cstack_list_pop(cstack, &cstack->free_list);
+    if (!ref) ref = cstack_grow(cstack, &err);
+    if (!ref){
+        if (cstack->max_length) cstack_release(cstack);
+        return err;
+    }
+
+    memcpy(cstack_node_data(cstack_node(cstack, ref - 1)), val, cstack->base.size);
+
+    if (!cstack->slots){
+        cstack_list_push(cstack, &cstack->top, ref - 1, ref - 1);
+    }else{
+        while (!cstack_try_push(cstack, ref - 1)){
+            if (cstack_eliminate_push(cstack, ref - 1)) break;
+        }
+    }
+
+    STACK_STATS_PUSH(&cstack->base, 1);
+    cstack_wake(&cstack->pop_seq, &cstack->pop_waiters);
+
+    return STACK_OK;
+}
+
+static stack_error_t cstack_push(stack_t* stack, void* val){
+    assert(stack && val);
+
+    stack_error_t err = cstack_add((cstack_t*)stack, val);
+    if (err) STACK_STATS_PUSH_FAILED(stack);
+
+    return err;
+}
+
+static void* cstack_peek(stack_t* stack){
+    assert(stack);
+
+    cstack_t *cstack = (cstack_t*)stack;
+    cstack_ref_t top = atomic_load_explicit(&cstack->top, memory_order_acquire);
+
+    if (REF_INDEX(top) == 0) return NULL;
+    return cstack_node_data(cstack_node(cstack, REF_INDEX(top) - 1));
+}
+
+static stack_error_t cstack_pop(stack_t* stack, void* popped){
+    assert(stack);
+
+    cstack_t *cstack = (cstack_t*)stack;
+
+    uint32_t ref = 0;
+
+    if (!cstack->slots){
+        ref = cstack_list_pop(cstack, &cstack->top);
+        if (!ref) return STACK_ERR_EMPTY;
+    }else{
+        for (;;){
+            try_result_t res = cstack_try_pop(cstack, &ref);
+            if (res == TRY_OK) break;
+            if (res == TRY_EMPTY) return STACK_ERR_EMPTY;
+            if (cstack_eliminate_pop(cstack, &ref)) break;
+        }
+    }
+
+    //le noeud nous appartient tant qu'il n'est pas rendu a la liste libre
+    if (popped)
+        memcpy(popped, cstack_node_data(cstack_node(cstack, ref - 1)), stack->size);
+
+    cstack_list_push(cstack, &cstack->free_list, ref - 1, ref - 1);
+    STACK_STATS_POP(stack, 1);
+
+    if (cstack->max_length) cstack_release(cstack);
+
+    return STACK_OK;
+}
+
+static bool cstack_is_empty(stack_t* stack){
+    assert(stack);
+    return REF_INDEX(atomic_load_explicit(&((cstack_t*)stack)->top, memory_order_acquire)) == 0;
+}
+
+//Endort le thread sur seq (inscrit dans waiters) si ready retourne false apres l'inscription
+//Retourne false si l'echeance est depassee
+static bool cstack_park(cstack_t* cstack, _Atomic uint32_t* seq, _Atomic uint32_t* waiters, bool (*ready)(cstack_t*), const struct timespec* deadline){
+    atomic_fetch_add_explicit(waiters, 1, memory_order_seq_cst);
+
+    uint32_t seen = atomic_load_explicit(seq, memory_order_acquire);
+    bool in_time = ready(cstack) || stack_futex_wait(seq, seen, deadline);
+
+    atomic_fetch_sub_explicit(waiters, 1, memory_order_relaxed);
+    return in_time;
+}
+
+static bool cstack_pop_ready(cstack_t* cstack){
+    return REF_INDEX(atomic_load_explicit(&cstack->top, memory_order_seq_cst)) != 0
+        || atomic_load_explicit(&cstack->closed, memory_order_seq_cst);
+}
+
+static bool cstack_push_ready(cstack_t* cstack){
+    return atomic_load_explicit(&cstack->length, memory_order_seq_cst) < cstack->max_length
+        || atomic_load_explicit(&cstack->closed, memory_order_seq_cst);
+}
+
+static stack_error_t cstack_pop_wait(stack_t* stack, void* popped, long timeout_ms){
+    assert(stack);
+
+    cstack_t *cstack = (cstack_t*)stack;
+    struct timespec deadline;
+    if (timeout_ms > 0) deadline = stack_wait_deadline(timeout_ms);
+
+    for (size_t i = 0;; i++){
+        stack_error_t err = cstack_pop(stack, popped);
+        if (err != STACK_ERR_EMPTY) return err;
+        if (atomic_load_explicit(&cstack->closed, memory_order_seq_cst)) return STACK_ERR_CLOSED;
+        if (timeout_ms == 0) return STACK_ERR_EMPTY;
+        if (i < CSTACK_WAIT_SPINS) continue;
+
+        if (!cstack_park(cstack, &cstack->pop_seq, &cstack->pop_waiters, cstack_pop_ready, timeout_ms > 0 ? &deadline : NULL))
+            timeout_ms = 0; //une derniere tentative, puis STACK_ERR_EMPTY
+    }
+}
+
+static stack_error_t cstack_push_wait(stack_t* stack, void* val, long timeout_ms){
+    assert(stack && val);
+
+    cstack_t *cstack = (cstack_t*)stack;
+    struct timespec deadline;
+    if (timeout_ms > 0) deadline = stack_wait_deadline(timeout_ms);
+
+    for (size_t i = 0;; i++){
+        stack_error_t err = cstack_add(cstack, val);
+        if (err != STACK_ERR_FULL || !cstack->max_length || timeout_ms == 0){
+            if (err) STACK_STATS_PUSH_FAILED(stack);
+            return err;
+        }
+        if (i < CSTACK_WAIT_SPINS) continue;
+
+        if (!cstack_park(cstack, &cstack->push_seq, &cstack->push_waiters, cstack_push_ready, timeout_ms > 0 ? &deadline : NULL))
+            timeout_ms = 0; //une derniere tentative, puis STACK_ERR_FULL
+    }
+}
+
+static void cstack_close(stack_t* stack){
+    assert(stack);
+
+    cstack_t *cstack = (cstack_t*)stack;
+    atomic_store_explicit(&cstack->closed, true, memory_order_seq_cst);
+
+    atomic_fetch_add_explicit(&cstack->pop_seq, 1, memory_order_release);
+    atomic_fetch_add_explicit(&cstack->push_seq, 1, memory_order_release);
+    stack_futex_wake(&cstack->pop_seq, INT_MAX);
+    stack_futex_wake(&cstack->push_seq, INT_MAX);
+}
@@ -0,0 +1,75 @@
+#ifndef __CSTACK_H__
+#define __CSTACK_H__
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "stack.h"
+
+// Taille d'une ligne de cache : top, free_list et chaque case d'elimination en occupent une entiere
+#define CSTACK_CACHE_LINE 64
+
+// Nombre maximal de segments de noeuds, le segment k contient first_length << k noeuds
+#define CSTACK_MAX_SEGMENTS 32
+
+// Une reference vers un noeud est un mot de 64 bits : (tag << 32) | (index + 1), 0 = NULL
+// Le tag est incremente a chaque modification pour eviter le probleme ABA
+typedef uint64_t cstack_ref_t;
+
+// Un noeud : next est l'index + 1 du noeud suivant (0 = fin), l'element suit l'entete
+typedef struct _cnode_t{
+    _Atomic uint32_t next;
+} cnode_t;
+
+// Une case du tableau d'elimination, seule sur sa ligne de cache
+// value est la reference vers le noeud offert par un push (index 0 = case vide)
+typedef struct _cslot_t{
+    _Atomic cstack_ref_t value;
+    char padding[CSTACK_CACHE_LINE - sizeof(cstack_ref_t)];
+} cslot_t;
+
+///@param top: La reference vers le noeud au sommet (seule sur sa ligne de cache)
+///@param free_list: La reference vers le premier noeud libre (seule sur sa ligne de cache)
+///@param segments: Les segments de noeuds alloues (jamais liberes avant la destruction)
+///@param first_length: Le nombre de noeuds du premier segment (puissance de 2)
+///@param node_stride: La taille d'un noeud (entete + element, aligne)
+///@param slots: Le tableau d'elimination, aligne sur une ligne de cache (NULL si desactive)
+///@param slots_raw: L'adresse renvoyee par l'allocateur pour slots (a liberer)
+///@param slot_count: Le nombre de cases du tableau d'elimination
+///@param slot_range: Le nombre de cases utilisees (ajuste si adaptive)
+///@param max_length: Le nombre maximal d'elements (0 = sans limite)
+///@param length: Le nombre d'elements, reserve avant chaque push (seulement si max_length)
+///@param closed: La pile a ete fermee par stack_close
+///@param pop_seq: Incremente par un push qui reveille un pop en attente (mot du futex)
+///@param pop_waiters: Le nombre de pops en attente
+///@param push_seq: Incremente par un pop qui reveille un push en attente (mot du futex)
+///@param push_waiters: Le nombre de push en attente
+///@param raw: L'adresse renvoyee par l'allocateur pour la structure, alignee sur une ligne de cache (a liberer)
+typedef struct _cstack_t{
+    stack_t base;
+    _Alignas(CSTACK_CACHE_LINE) _Atomic cstack_ref_t top;
+    _Alignas(CSTACK_CACHE_LINE) _Atomic cstack_ref_t free_list;
+    _Alignas(CSTACK_CACHE_LINE) _Atomic(char*) segments[CSTACK_MAX_SEGMENTS];
+    size_t first_length;
+    size_t node_stride;
+
+    cslot_t *slots;
+    void *slots_raw;
+    size_t slot_count;
+    _Atomic size_t slot_range;
+    bool adaptive;
+    size_t spins;
+
+    size_t max_length;
+    _Atomic size_t length;
+    _Atomic bool closed;
+    _Atomic uint32_t pop_seq;
+    _Atomic uint32_t pop_waiters;
+    _Atomic uint32_t push_seq;
+    _Atomic uint32_t push_waiters;
+    void *raw;
+} cstack_t;
+
+int cstack_init(cstack_t* stack, cstack_config_t config);
+
+#endif // __CSTACK_H__
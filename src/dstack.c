@@ -2,38 +2,92 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 
 #include "stack.h"
 #include "dstack.h"
+#include "alloc.h"
+#include "pool.h"
+#include "stats.h"
+#include "search.h"
+
+// Taille de l'entete d'un bloc, arrondie pour que les elements soient correctement alignes
+#define NODE_HEADER_SIZE ((sizeof(node_t) + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1))
 
 static void dstack_destroy(stack_t** stack_ptr);
-static int dstack_push(stack_t* stack, void* val);
+static stack_error_t dstack_push(stack_t* stack, void* val);
 static void* dstack_peek(stack_t* stack);
-static void* dstack_pop(stack_t* stack, void* popped);
+static stack_error_t dstack_pop(stack_t* stack, void* popped);
 static bool dstack_is_empty(stack_t* stack);
+static stack_error_t dstack_push_n(stack_t* stack, const void* vals, size_t n);
+static size_t dstack_pop_n(stack_t* stack, void* out, size_t n, stack_order_t order);
+static void* dstack_emplace(stack_t* stack, stack_error_t* err);
+static void* dstack_pop_view(stack_t* stack);
+static size_t dstack_count(stack_t* stack);
+static void dstack_truncate(stack_t* stack, size_t count);
+static void* dstack_at(stack_t* stack, size_t depth);
+static stack_error_t dstack_foreach(stack_t* stack, stack_order_t order, stack_visitor_t visit, void* ctx);
+static void* dstack_find(stack_t* stack, const void* val);
+static stack_error_t dstack_save(stack_t* stack, FILE* file);
+static stack_error_t dstack_load(stack_t* stack, FILE* file, size_t count);
+static size_t dstack_shrink(stack_t* stack);
+static void dstack_select_sized_ops(stack_t* stack);
 
 int dstack_init(dstack_t* stack, dstack_config_t config){
     if (!stack) return (fprintf(stderr, "[!] dstack_init : invalid stack pointer\n"), -1);
     if (config.size == 0) return (fprintf(stderr, "[!] dstack_init : invalid config size : size must be > 0\n"), -1);
 
+    size_t chunk_length = config.chunk_length ? config.chunk_length : DSTACK_DEFAULT_CHUNK_LENGTH;
+    if (chunk_length > (SIZE_MAX - NODE_HEADER_SIZE) / config.size)
+        return (fprintf(stderr, "[!] dstack_init : invalid config chunk_length : chunk is too large\n"), -1);
+    if (config.pool && config.pool->block_size && config.pool->block_size < NODE_HEADER_SIZE + chunk_length * config.size)
+        return (fprintf(stderr, "[!] dstack_init : invalid config pool : pool blocks are too small for a chunk\n"), -1);
+
     memset(stack, 0, sizeof(*stack));
 
     stack->base = (stack_t){
         .type = STACK_TYPE_DYNAMIC,
         .size = config.size,
+        .allocator = config.allocator,
         .destroy = dstack_destroy,
         .push = dstack_push,
         .peek = dstack_peek,
         .pop = dstack_pop,
-        .is_empty = dstack_is_empty
+        .is_empty = dstack_is_empty,
+        .push_n = dstack_push_n,
+        .pop_n = dstack_pop_n,
+        .emplace = dstack_emplace,
+        .pop_view = dstack_pop_view,
+        .count = dstack_count,
+        .truncate = dstack_truncate,
+        .at = dstack_at,
+        .foreach = dstack_foreach,
+        .find = dstack_find,
+        .save = dstack_save,
+        .load = dstack_load,
+        .shrink = dstack_shrink
     };
+    dstack_select_sized_ops(&stack->base);
 
     stack->top = NULL;
+    stack->top_count = 0;
+    stack->count = 0;
+    stack->chunk_length = chunk_length;
+    stack->spare = NULL;
+    stack->pool = config.pool;
 
     return 0;
 }
 
+//Rend un bloc a son pool ou a l'allocateur de la pile
+static void dstack_release_chunk(dstack_t* dstack, node_t* n){
+    STACK_STATS_FREE(dstack, NODE_HEADER_SIZE + dstack->chunk_length * dstack->base.size);
+    if(dstack->pool) pool_free(dstack->pool, n);
+    else stack_mem_free(dstack->base.allocator, n);
+}
+
 static void dstack_destroy(stack_t** stack_ptr){
     assert(stack_ptr && *stack_ptr);
     dstack_t *stack = (dstack_t*)*stack_ptr;
@@ -41,31 +95,99 @@ static void dstack_destroy(stack_t** stack_ptr){
     while(stack->top){
         node_t *tmp = stack->top;
         stack->top = stack->top->next;
-        free(tmp);
+        dstack_release_chunk(stack, tmp);
     }
 
-    free(stack);
+    if(stack->spare) dstack_release_chunk(stack, stack->spare);
+    stack_mem_free(stack->base.allocator, stack);
     *stack_ptr = NULL;
 }
 
+//Retourne un bloc vide : le bloc de reserve s'il existe, sinon un nouveau bloc
+static node_t* dstack_take_chunk(dstack_t* dstack){
+    node_t *n = dstack->spare;
+    if(n){
+        dstack->spare = NULL;
+        return n;
+    }
+
+    size_t bytes = NODE_HEADER_SIZE + dstack->chunk_length * dstack->base.size;
+    if(dstack->pool){
+        n = pool_alloc(dstack->pool, bytes);
+        if(!n) return NULL;
+    }else{
+        n = stack_mem_alloc(dstack->base.allocator, bytes);
+        if(!n) return NULL;
+    }
+    STACK_STATS_ALLOC(dstack, bytes);
+
+    n->data = (char*)n + NODE_HEADER_SIZE;
+    return n;
+}
+
+//Ajoute un bloc vide au sommet de la pile (un echec compte comme un ajout refuse)
+static stack_error_t dstack_push_chunk(dstack_t* dstack){
+    node_t *n = dstack_take_chunk(dstack);
+    if(!n){
+        STACK_STATS_PUSH_FAILED(dstack);
+        return STACK_ERR_NO_MEMORY;
+    }
+
+    n->next = dstack->top;
+    dstack->top = n;
+    dstack->top_count = 0;
+
+    return STACK_OK;
+}
+
+//Retire le bloc au sommet, qui est vide : il devient le bloc de reserve, les blocs suivants sont pleins
+static void dstack_drop_top_chunk(dstack_t* dstack){
+    node_t *n = dstack->top;
+    dstack->top = n->next;
+    dstack->top_count = dstack->top ? dstack->chunk_length : 0;
+
+    if(dstack->spare) dstack_release_chunk(dstack, dstack->spare);
+    dstack->spare = n;
+}
+
+//Les blocs vides sont rendus des qu'ils quittent le sommet : seul le bloc de reserve reste a liberer
+//(avec un pool, il retourne dans le pool et non au systeme)
+static size_t dstack_shrink(stack_t* stack){
+    assert(stack);
+
+    dstack_t *dstack = (dstack_t*)stack;
+    if(!dstack->spare) return 0;
+
+    size_t bytes = NODE_HEADER_SIZE + dstack->chunk_length * stack->size;
+    dstack_release_chunk(dstack, dstack->spare);
+    dstack->spare = NULL;
+    STACK_STATS_TRIM(stack, bytes);
+
+    return bytes;
+}
+
 //Fait une COPIE de la valeur et l'ajoute au sommet de la pile
-static int dstack_push(stack_t* stack, void* val){
+//size est une constante dans les versions specialisees (le memcpy devient quelques mov)
+static inline stack_error_t dstack_push_sized(stack_t* stack, void* val, size_t size){
     assert(stack && val);
 
     dstack_t *dstack = (dstack_t*)stack;
-    
-    node_t *n = malloc(sizeof(*n));
-    if(!n) return (perror("malloc failed"), -1);
-
-    n->data = malloc(stack->size);
-    if(!n->data) return (perror("malloc failed"), -1);
-    
-    memcpy(n->data, val, stack->size);
-    
-    n->next = dstack->top;
-    dstack->top = n;
-    
-    return 0;
+
+    if(!dstack->top || dstack->top_count == dstack->chunk_length){
+        if(dstack_push_chunk(dstack)) return STACK_ERR_NO_MEMORY;
+    }
+
+    void *dest = (char*)dstack->top->data + dstack->top_count * size;
+    memcpy(dest, val, size);
+    dstack->top_count++;
+    dstack->count++;
+    STACK_STATS_PUSH(stack, 1);
+
+    return STACK_OK;
+}
+
+static stack_error_t dstack_push(stack_t* stack, void* val){
+    return dstack_push_sized(stack, val, stack->size);
 }
 
 static void* dstack_peek(stack_t* stack){
@@ -73,25 +195,29 @@ static void* dstack_peek(stack_t* stack){
     dstack_t *dstack = (dstack_t*)stack;
 
     if(dstack_is_empty(stack)) return NULL;
-    return dstack->top->data;
+    return (char*)dstack->top->data + (dstack->top_count - 1) * stack->size;
 }
 
-static void* dstack_pop(stack_t* stack, void* popped){
+static inline stack_error_t dstack_pop_sized(stack_t* stack, void* popped, size_t size){
     assert(stack);
     dstack_t *dstack = (dstack_t*)stack;
 
-    if(dstack_is_empty(stack)) return NULL;
+    if(dstack_is_empty(stack)) return STACK_ERR_EMPTY;
 
-    node_t *n = dstack->top;
-    dstack->top = n->next;
+    dstack->top_count--;
+    dstack->count--;
+    STACK_STATS_POP(stack, 1);
 
     if(popped)
-        memcpy(popped, n->data, stack->size);
+        memcpy(popped, (char*)dstack->top->data + dstack->top_count * size, size);
 
-    free(n->data);
-    free(n);
+    if(dstack->top_count == 0) dstack_drop_top_chunk(dstack);
+
+    return STACK_OK;
+}
 
-    return popped;
+static stack_error_t dstack_pop(stack_t* stack, void* popped){
+    return dstack_pop_sized(stack, popped, stack->size);
 }
 
 static bool dstack_is_empty(stack_t* stack){
@@ -99,4 +225,296 @@ static bool dstack_is_empty(stack_t* stack){
     return ((dstack_t*)stack)->top == NULL;
 }
 
+//Remplit le bloc au sommet puis ajoute des blocs, avec un memcpy par bloc
+//En cas d'echec d'allocation, les elements deja copies restent dans la pile
+static stack_error_t dstack_push_n(stack_t* stack, const void* vals, size_t n){
+    assert(stack && vals);
+
+    dstack_t *dstack = (dstack_t*)stack;
+    const char *src = vals;
+
+    while(n > 0){
+        if(!dstack->top || dstack->top_count == dstack->chunk_length){
+            if(dstack_push_chunk(dstack)) return STACK_ERR_NO_MEMORY;
+        }
+
+        size_t room = dstack->chunk_length - dstack->top_count;
+        size_t k = n < room ? n : room;
+
+        memcpy((char*)dstack->top->data + dstack->top_count * stack->size, src, k * stack->size);
+        dstack->top_count += k;
+        dstack->count += k;
+        STACK_STATS_PUSH(stack, k);
+
+        src += k * stack->size;
+        n -= k;
+    }
+
+    return STACK_OK;
+}
+
+static size_t dstack_pop_n(stack_t* stack, void* out, size_t n, stack_order_t order){
+    assert(stack);
+
+    dstack_t *dstack = (dstack_t*)stack;
+    size_t total = n < dstack->count ? n : dstack->count;
+    size_t done = 0;
+
+    while(done < total){
+        size_t k = total - done < dstack->top_count ? total - done : dstack->top_count;
+        char *src = (char*)dstack->top->data + (dstack->top_count - k) * stack->size;
+
+        if(out && order == STACK_ORDER_BOTTOM_UP){
+            //les elements les plus hauts vont a la fin de out
+            memcpy((char*)out + (total - done - k) * stack->size, src, k * stack->size);
+        }else if(out){
+            for(size_t i = 0; i < k; i++)
+                memcpy((char*)out + (done + i) * stack->size, src + (k - 1 - i) * stack->size, stack->size);
+        }
+
+        dstack->top_count -= k;
+        dstack->count -= k;
+        STACK_STATS_POP(stack, k);
+        done += k;
+
+        if(dstack->top_count == 0) dstack_drop_top_chunk(dstack);
+    }
+
+    return total;
+}
+
+static void* dstack_emplace(stack_t* stack, stack_error_t* err){
+    assert(stack && err);
+
+    dstack_t *dstack = (dstack_t*)stack;
+
+    if(!dstack->top || dstack->top_count == dstack->chunk_length){
+        if((*err = dstack_push_chunk(dstack))) return NULL;
+    }
+
+    dstack->count++;
+    STACK_STATS_PUSH(stack, 1);
+    return (char*)dstack->top->data + (dstack->top_count++) * stack->size;
+}
+
+//Si le bloc au sommet se vide, il devient le bloc de reserve :
+//l'element reste donc valide jusqu'au prochain push qui reutilisera ce bloc
+static void* dstack_pop_view(stack_t* stack){
+    assert(stack);
+
+    dstack_t *dstack = (dstack_t*)stack;
+
+    if(dstack_is_empty(stack)) return NULL;
+
+    dstack->top_count--;
+    dstack->count--;
+    STACK_STATS_POP(stack, 1);
+
+    void *res = (char*)dstack->top->data + dstack->top_count * stack->size;
+
+    if(dstack->top_count == 0) dstack_drop_top_chunk(dstack);
+
+    return res;
+}
+
+static size_t dstack_count(stack_t* stack){
+    assert(stack);
+    return ((dstack_t*)stack)->count;
+}
+
+//Retire les blocs entiers sans toucher a leurs elements (le premier devient le bloc de reserve),
+//puis recule dans le bloc restant au sommet
+static void dstack_truncate(stack_t* stack, size_t count){
+    assert(stack);
+
+    dstack_t *dstack = (dstack_t*)stack;
+    assert(count <= dstack->count);
+
+    size_t removed = dstack->count - count;
+    STACK_STATS_POP(stack, removed);
+
+    while(removed && removed >= dstack->top_count){
+        removed -= dstack->top_count;
+
+        node_t *n = dstack->top;
+        dstack->top = n->next;
+        dstack->top_count = dstack->top ? dstack->chunk_length : 0;
+
+        if(dstack->spare) dstack_release_chunk(dstack, n);
+        else dstack->spare = n;
+    }
+
+    dstack->top_count -= removed;
+    dstack->count = count;
+}
+
+//Retourne les blocs du fond vers le sommet dans un tableau temporaire (a liberer avec stack_mem_free), sans toucher a la liste
+static node_t** dstack_chunks_bottom_up(dstack_t* dstack, size_t* chunks){
+    size_t n = 0;
+    for(node_t *node = dstack->top; node; node = node->next) n++;
+
+    *chunks = n;
+    if(n == 0 || n > SIZE_MAX / sizeof(node_t*)) return NULL;
+
+    node_t **nodes = stack_mem_alloc(dstack->base.allocator, n * sizeof(node_t*));
+    if(!nodes) return NULL;
+
+    for(node_t *node = dstack->top; node; node = node->next) nodes[--n] = node;
+    return nodes;
+}
+
+//Saute les blocs entiers au-dessus de l'element, puis indexe dans son bloc
+static void* dstack_at(stack_t* stack, size_t depth){
+    assert(stack);
+
+    dstack_t *dstack = (dstack_t*)stack;
+    if(depth >= dstack->count) return NULL;
+
+    node_t *n = dstack->top;
+    size_t k = dstack->top_count;
+    while(depth >= k){
+        depth -= k;
+        n = n->next;
+        k = dstack->chunk_length;
+    }
+
+    return (char*)n->data + (k - 1 - depth) * stack->size;
+}
+
+//Du fond vers le sommet, les blocs sont parcourus depuis un tableau de pointeurs : la liste reste intacte
+//pendant les appels a visit (qui peut lire la pile avec stack_at, stack_peek ou stack_find)
+static stack_error_t dstack_foreach(stack_t* stack, stack_order_t order, stack_visitor_t visit, void* ctx){
+    assert(stack && visit);
+
+    dstack_t *dstack = (dstack_t*)stack;
+    bool stop = false;
+
+    if(order == STACK_ORDER_TOP_DOWN){
+        for(node_t *n = dstack->top; n && !stop; n = n->next){
+            size_t k = n == dstack->top ? dstack->top_count : dstack->chunk_length;
+            while(k-- && !stop)
+                stop = !visit((char*)n->data + k * stack->size, ctx);
+        }
+        return STACK_OK;
+    }
+
+    size_t chunks;
+    node_t **nodes = dstack_chunks_bottom_up(dstack, &chunks);
+    if(!nodes) return chunks ? STACK_ERR_NO_MEMORY : STACK_OK;
+
+    for(size_t c = 0; c < chunks && !stop; c++){
+        size_t k = nodes[c] == dstack->top ? dstack->top_count : dstack->chunk_length;
+        for(size_t i = 0; i < k && !stop; i++)
+            stop = !visit((char*)nodes[c]->data + i * stack->size, ctx);
+    }
+
+    stack_mem_free(stack->allocator, nodes);
+    return STACK_OK;
+}
+
+//Chaque bloc est contigu : la recherche se fait bloc par bloc, du sommet vers le fond
+static void* dstack_find(stack_t* stack, const void* val){
+    assert(stack && val);
+
+    dstack_t *dstack = (dstack_t*)stack;
+
+    for(node_t *n = dstack->top; n; n = n->next){
+        size_t k = n == dstack->top ? dstack->top_count : dstack->chunk_length;
+        size_t index = stack_search_last(n->data, k, stack->size, val);
+        if(index != STACK_SEARCH_NOT_FOUND) return (char*)n->data + index * stack->size;
+    }
+
+    return NULL;
+}
+
+//Les blocs sont chaines du sommet vers le fond : ils sont ecrits du fond vers le sommet depuis un tableau
+//de pointeurs (un fwrite par bloc, tamponne par stdio), la pile n'est jamais modifiee
+static stack_error_t dstack_save(stack_t* stack, FILE* file){
+    assert(stack && file);
+
+    dstack_t *dstack = (dstack_t*)stack;
+    stack_error_t err = STACK_OK;
+
+    size_t chunks;
+    node_t **nodes = dstack_chunks_bottom_up(dstack, &chunks);
+    if(!nodes) return chunks ? STACK_ERR_NO_MEMORY : STACK_OK;
+
+    for(size_t i = 0; i < chunks && !err; i++){
+        size_t k = nodes[i] == dstack->top ? dstack->top_count : dstack->chunk_length;
+        if(fwrite(nodes[i]->data, stack->size, k, file) != k) err = STACK_ERR_IO;
+    }
+
+    stack_mem_free(stack->allocator, nodes);
+    return err;
+}
+
+//Lit les elements directement dans les blocs, un fread par bloc
+static stack_error_t dstack_load(stack_t* stack, FILE* file, size_t count){
+    assert(stack && file);
+
+    dstack_t *dstack = (dstack_t*)stack;
+
+    while(count){
+        if(!dstack->top || dstack->top_count == dstack->chunk_length){
+            if(dstack_push_chunk(dstack)) return STACK_ERR_NO_MEMORY;
+        }
+
+        size_t room = dstack->chunk_length - dstack->top_count;
+        size_t k = count < room ? count : room;
+
+        if(fread((char*)dstack->top->data + dstack->top_count * stack->size, stack->size, k, file) != k){
+            //un bloc ajoute pour cette lecture ne doit pas rester vide au sommet
+            if(dstack->top_count == 0) dstack_drop_top_chunk(dstack);
+            return STACK_ERR_IO;
+        }
+
+        dstack->top_count += k;
+        dstack->count += k;
+        STACK_STATS_PUSH(stack, k);
+        count -= k;
+    }
 
+    return STACK_OK;
+}
+
+// Versions de push et pop specialisees pour les tailles d'element courantes
+#define DSTACK_SIZED_OPS(N)                                                         \
+    static stack_error_t dstack_push_##N(stack_t* stack, void* val){                \
+        return dstack_push_sized(stack, val, N);                                    \
+    }                                                                               \
+    static stack_error_t dstack_pop_##N(stack_t* stack, void* popped){              \
+        return dstack_pop_sized(stack, popped, N);                                  \
+    }
+
+DSTACK_SIZED_OPS(1)
+DSTACK_SIZED_OPS(2)
+DSTACK_SIZED_OPS(4)
+DSTACK_SIZED_OPS(8)
+DSTACK_SIZED_OPS(16)
+DSTACK_SIZED_OPS(32)
+DSTACK_SIZED_OPS(64)
+
+static const struct {
+    size_t size;
+    stack_error_t (*push)(stack_t* self, void* val);
+    stack_error_t (*pop)(stack_t* self, void* popped);
+} dstack_sized_ops[] = {
+    {1, dstack_push_1, dstack_pop_1},
+    {2, dstack_push_2, dstack_pop_2},
+    {4, dstack_push_4, dstack_pop_4},
+    {8, dstack_push_8, dstack_pop_8},
+    {16, dstack_push_16, dstack_pop_16},
+    {32, dstack_push_32, dstack_pop_32},
+    {64, dstack_push_64, dstack_pop_64},
+};
+
+//Remplace push et pop par leur version specialisee si la taille d'element en a une
+static void dstack_select_sized_ops(stack_t* stack){
+    for (size_t i = 0; i < sizeof(dstack_sized_ops) / sizeof(dstack_sized_ops[0]); i++){
+        if (dstack_sized_ops[i].size != stack->size) continue;
+
+        stack->push = dstack_sized_ops[i].push;
+        stack->pop = dstack_sized_ops[i].pop;
+        return;
+    }
+}
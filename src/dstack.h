@@ -3,14 +3,27 @@
 
 #include "stack.h"
 
+// Un bloc de la pile : data pointe sur chunk_length elements contigus
+// alloues dans le meme malloc que le noeud
 typedef struct _node_t{
     void *data;
     struct _node_t *next;
 } node_t;
 
+///@param top: Le bloc au sommet de la pile (NULL si la pile est vide)
+///@param top_count: Le nombre d'elements dans le bloc au sommet (les blocs suivants sont pleins)
+///@param count: Le nombre total d'elements dans la pile
+///@param chunk_length: Le nombre d'elements par bloc
+///@param spare: Un bloc vide garde en reserve pour ne pas reallouer a chaque frontiere de bloc
+///@param pool: Le pool d'ou viennent les blocs (NULL = base.allocator)
 typedef struct _dstack_t {
     stack_t base;
     node_t *top;
+    size_t top_count;
+    size_t count;
+    size_t chunk_length;
+    node_t *spare;
+    stack_pool_t *pool;
 } dstack_t;
 
 int dstack_init(dstack_t* stack, dstack_config_t config);
@@ -3,39 +3,137 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <stdint.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 #include "stack.h"
 #include "fstack.h"
+#include "alloc.h"
+#include "stats.h"
+#include "search.h"
+#include "trim.h"
 
 static void fstack_destroy(stack_t** stack_ptr);
-static int fstack_push(stack_t* stack, void* val);
+static stack_error_t fstack_push(stack_t* stack, void* val);
 static void* fstack_peek(stack_t* stack);
-static void* fstack_pop(stack_t* stack, void* popped);
+static stack_error_t fstack_pop(stack_t* stack, void* popped);
 static bool fstack_is_empty(stack_t* stack);
+static stack_error_t fstack_push_n(stack_t* stack, const void* vals, size_t n);
+static size_t fstack_pop_n(stack_t* stack, void* out, size_t n, stack_order_t order);
+static void* fstack_emplace(stack_t* stack, stack_error_t* err);
+static void* fstack_pop_view(stack_t* stack);
+static size_t fstack_count(stack_t* stack);
+static void fstack_truncate(stack_t* stack, size_t count);
+static void* fstack_at(stack_t* stack, size_t depth);
+static stack_error_t fstack_foreach(stack_t* stack, stack_order_t order, stack_visitor_t visit, void* ctx);
+static void* fstack_find(stack_t* stack, const void* val);
+static stack_error_t fstack_save(stack_t* stack, FILE* file);
+static stack_error_t fstack_load(stack_t* stack, FILE* file, size_t count);
+static size_t fstack_shrink(stack_t* stack);
+static void fstack_select_sized_ops(stack_t* stack);
+static stack_error_t fstack_push_trim(stack_t* stack, void* val);
+static stack_error_t fstack_pop_trim(stack_t* stack, void* popped);
 
-int fstack_init(fstack_t* stack, fstack_config_t config){
+// Taille d'une page de memoire transparente (THP) sur x86-64 et arm64
+#define FSTACK_HUGE_PAGE_SIZE ((size_t)2 << 20)
+
+//L'alignement du tableau : celui de la configuration, 2 Mo pour huge_pages, au moins celui de malloc
+static size_t fstack_data_alignment(fstack_config_t config, size_t bytes){
+    size_t alignment = config.alignment;
+    if (config.huge_pages && bytes >= FSTACK_HUGE_PAGE_SIZE && alignment < FSTACK_HUGE_PAGE_SIZE)
+        alignment = FSTACK_HUGE_PAGE_SIZE;
+
+    return alignment > _Alignof(max_align_t) ? alignment : _Alignof(max_align_t);
+}
+
+//L'en-tete est aligne comme malloc : un tableau plus aligne demande au plus alignment - _Alignof(max_align_t) octets de plus
+size_t fstack_storage_bytes(fstack_config_t config){
+    if (config.size && config.length > SIZE_MAX / config.size) return 0;
+
+    size_t bytes = config.length * config.size;
+    size_t slack = fstack_data_alignment(config, bytes) - _Alignof(max_align_t);
+    if (bytes > SIZE_MAX - FSTACK_HEADER_BYTES - slack) return 0;
+
+    return FSTACK_HEADER_BYTES + slack + bytes;
+}
+
+//Applique les options huge_pages, prefault et lock au tableau
+static int fstack_prepare_data(fstack_t* stack, fstack_config_t config){
+    //madvise n'est qu'un conseil : un echec (THP desactive) n'empeche pas la creation
+    if (config.huge_pages && stack->bytes >= FSTACK_HUGE_PAGE_SIZE && ((uintptr_t)stack->data & (FSTACK_HUGE_PAGE_SIZE - 1)) == 0)
+        madvise(stack->data, stack->bytes & ~(FSTACK_HUGE_PAGE_SIZE - 1), MADV_HUGEPAGE);
+
+    if (config.prefault){
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        volatile char *p = stack->data;
+        for (size_t i = 0; i < stack->bytes; i += page) p[i] = p[i];
+    }
+
+    if (config.lock){
+        if (mlock(stack->data, stack->bytes)) return (perror("mlock failed"), -1);
+        stack->locked = true;
+    }
+
+    return 0;
+}
+
+int fstack_init(fstack_t* stack, fstack_config_t config, bool zeroed){
     if (!stack) return (fprintf(stderr, "[!] fstack_init : invalid stack pointer\n"), -1);
     if (config.size == 0) return (fprintf(stderr, "[!] fstack_init : invalid config size : size must be > 0\n"), -1);
     if (config.length == 0) return (fprintf(stderr, "[!] fstack_init : invalid config length : length must be > 0\n"), -1);
+    if (config.alignment & (config.alignment - 1)) return (fprintf(stderr, "[!] fstack_init : invalid config alignment : alignment must be a power of 2\n"), -1);
+    if (!fstack_storage_bytes(config)) return (fprintf(stderr, "[!] fstack_init : invalid config length : buffer is too large\n"), -1);
+    if (!stack_trim_policy_check(&config.trim)) return (fprintf(stderr, "[!] fstack_init : invalid config trim : low_watermark must be in [0, 1[ and low_watermark * headroom < 1\n"), -1);
 
     memset(stack, 0, sizeof(*stack));
 
     stack->base = (stack_t){
         .type = STACK_TYPE_FIXED,
         .size = config.size,
+        .allocator = config.allocator,
         .destroy = fstack_destroy,
         .push = fstack_push,
         .peek = fstack_peek,
         .pop = fstack_pop,
-        .is_empty = fstack_is_empty
+        .is_empty = fstack_is_empty,
+        .push_n = fstack_push_n,
+        .pop_n = fstack_pop_n,
+        .emplace = fstack_emplace,
+        .pop_view = fstack_pop_view,
+        .count = fstack_count,
+        .truncate = fstack_truncate,
+        .at = fstack_at,
+        .foreach = fstack_foreach,
+        .find = fstack_find,
+        .save = fstack_save,
+        .load = fstack_load,
+        .shrink = fstack_shrink
     };
+    fstack_select_sized_ops(&stack->base);
+
+    //la politique de trim remplace les versions specialisees : push rearme le seuil, pop le teste
+    if (config.trim.low_watermark){
+        stack->base.push = fstack_push_trim;
+        stack->base.pop = fstack_pop_trim;
+    }
 
-    stack->data = calloc(config.length, config.size);
-    if (!stack->data) return (perror("calloc failed"), -1);
+    //le tableau commence a la premiere adresse alignee apres l'en-tete
+    size_t alignment = fstack_data_alignment(config, config.length * config.size);
+    stack->data = (void*)(((uintptr_t)stack + FSTACK_HEADER_BYTES + alignment - 1) & ~(uintptr_t)(alignment - 1));
+    stack->bytes = config.length * config.size;
+    if (!config.no_zero && !zeroed) memset(stack->data, 0, stack->bytes);
 
+    if (fstack_prepare_data(stack, config)) return -1;
+
+    //un tableau efface ou touche page par page a la creation est entierement en memoire
     stack->top = 0;
     stack->length = config.length;
+    stack->high_water = (!config.no_zero && !zeroed) || config.prefault ? config.length : 0;
+    stack->trim = config.trim;
+    stack->trim_below = stack_trim_threshold(&config.trim, config.length, config.size);
+    stack->trim_mark = SIZE_MAX;
 
     return 0;
 }
@@ -43,27 +141,127 @@ int fstack_init(fstack_t* stack, fstack_config_t config){
 static void fstack_destroy(stack_t** stack){
     assert(stack && *stack);
     
-    free(((fstack_t*)*stack)->data);
-    free(*stack);
+    fstack_t *fstack = (fstack_t*)*stack;
+    const stack_allocator_t *allocator = (*stack)->allocator;
+
+    if (fstack->locked) munlock(fstack->data, fstack->bytes);
+    stack_mem_free(allocator, *stack);
     *stack = NULL;
 }
 
-static int fstack_push(stack_t* stack, void* val){
+//Apres un ajout : les pages jusqu'au sommet sont maintenant utilisees
+static inline void fstack_touch(fstack_t* fstack){
+    if (fstack->top > fstack->high_water) fstack->high_water = fstack->top;
+}
+
+//Corps de push et pop : size est une constante dans les versions specialisees (le memcpy devient quelques mov)
+static inline stack_error_t fstack_push_sized(stack_t* stack, void* val, size_t size){
     assert(stack && val);
 
     fstack_t *fstack = (fstack_t*)stack;
     
     if(fstack->top == fstack->length){
-        fprintf(stderr, "[!] fstack_push : unable to push, stack is full\n");
-        return 1;
+        STACK_STATS_PUSH_FAILED(stack);
+        return STACK_ERR_FULL;
     }
     
-    void* dest = ((char*)fstack->data)+(fstack->top * stack->size);
-    memcpy(dest, val, stack->size);
+    void* dest = ((char*)fstack->data)+(fstack->top * size);
+    memcpy(dest, val, size);
 
     fstack->top++;
+    fstack_touch(fstack);
+    STACK_STATS_PUSH(stack, 1);
 
-    return 0;
+    return STACK_OK;
+}
+
+static inline stack_error_t fstack_pop_sized(stack_t* stack, void* popped, size_t size){
+    assert(stack);
+
+    fstack_t *fstack = (fstack_t*)stack;
+
+    if(fstack->top == 0)
+        return STACK_ERR_EMPTY;
+
+    fstack->top--;
+    STACK_STATS_POP(stack, 1);
+
+    if(popped)
+        memcpy(popped, ((char*)fstack->data)+(fstack->top * size), size);
+
+    return STACK_OK;
+}
+
+static stack_error_t fstack_push(stack_t* stack, void* val){
+    return fstack_push_sized(stack, val, stack->size);
+}
+
+//Rend au systeme les pages entieres du tableau entre keep et high_water elements, retourne le nombre d'octets rendus
+//Au-dela de high_water rien n'a ete ecrit : la derniere page est rendue en entier si elle reste dans le tableau.
+//Le tableau reste alloue : une page rendue est relue a zero au prochain acces (ou depuis le fichier, selon l'allocateur)
+static size_t fstack_release_pages(fstack_t* fstack, size_t keep){
+    if (fstack->locked || keep >= fstack->high_water) return 0;
+
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t data = (uintptr_t)fstack->data;
+    uintptr_t start = (data + keep * fstack->base.size + page - 1) & ~(page - 1);
+    uintptr_t end = (data + fstack->high_water * fstack->base.size + page - 1) & ~(page - 1);
+    uintptr_t limit = (data + fstack->bytes) & ~(page - 1);
+    if (end > limit) end = limit;
+
+    if (end > start && madvise((void*)start, end - start, MADV_DONTNEED)) return 0;
+
+    fstack->high_water = keep;
+    if (end <= start) return 0;
+
+    STACK_STATS_TRIM(fstack, end - start);
+    return end - start;
+}
+
+//Applique la politique de trim apres un retrait (jamais apres pop_view : l'element retire doit rester lisible)
+static inline void fstack_auto_trim(fstack_t* fstack){
+    if (fstack->top >= fstack->trim_below) return;
+
+    size_t keep = stack_trim_keep(&fstack->trim, fstack->top);
+    fstack_release_pages(fstack, keep);
+
+    fstack->trim_mark = keep;
+    fstack->trim_below = stack_trim_threshold(&fstack->trim, keep, fstack->base.size);
+}
+
+//Apres un ajout : des pages au-dela de trim_mark sont de nouveau utilisees, le seuil porte sur tout le tableau
+//(les push des piles typees de tstack.h ne passent pas ici : seul stack_shrink_to_fit rend alors leurs pages)
+static inline void fstack_rearm_trim(fstack_t* fstack){
+    if (fstack->top <= fstack->trim_mark) return;
+
+    fstack->trim_mark = SIZE_MAX;
+    fstack->trim_below = stack_trim_threshold(&fstack->trim, fstack->length, fstack->base.size);
+}
+
+static stack_error_t fstack_push_trim(stack_t* stack, void* val){
+    stack_error_t err = fstack_push_sized(stack, val, stack->size);
+    fstack_rearm_trim((fstack_t*)stack);
+    return err;
+}
+
+static stack_error_t fstack_pop_trim(stack_t* stack, void* popped){
+    stack_error_t err = fstack_pop_sized(stack, popped, stack->size);
+    fstack_auto_trim((fstack_t*)stack);
+    return err;
+}
+
+static size_t fstack_shrink(stack_t* stack){
+    assert(stack);
+
+    fstack_t *fstack = (fstack_t*)stack;
+    size_t bytes = fstack_release_pages(fstack, fstack->top);
+
+    if (fstack->trim.low_watermark){
+        fstack->trim_mark = fstack->top;
+        fstack->trim_below = stack_trim_threshold(&fstack->trim, fstack->top, stack->size);
+    }
+
+    return bytes;
 }
 
 static void* fstack_peek(stack_t* stack){
@@ -78,33 +276,208 @@ static void* fstack_peek(stack_t* stack){
     return ((char*)fstack->data)+(fstack->top - 1) * stack->size;
 }
 
-static void* fstack_pop(stack_t* stack, void* popped){
-    if(!stack){
-        fprintf(stderr, "[!] fstack_pop : unable to pop, given stack pointer is NULL\n");
+static stack_error_t fstack_pop(stack_t* stack, void* popped){
+    return fstack_pop_sized(stack, popped, stack->size);
+}
+
+static bool fstack_is_empty(stack_t* stack){
+    assert(stack);
+    return ((fstack_t*)stack)->top == 0;
+}
+
+static stack_error_t fstack_push_n(stack_t* stack, const void* vals, size_t n){
+    assert(stack && vals);
+
+    fstack_t *fstack = (fstack_t*)stack;
+
+    if(n > fstack->length - fstack->top){
+        STACK_STATS_PUSH_FAILED(stack);
+        return STACK_ERR_FULL;
+    }
+
+    memcpy(((char*)fstack->data)+(fstack->top * stack->size), vals, n * stack->size);
+    fstack->top += n;
+    fstack_touch(fstack);
+    STACK_STATS_PUSH(stack, n);
+    fstack_rearm_trim(fstack);
+
+    return STACK_OK;
+}
+
+static size_t fstack_pop_n(stack_t* stack, void* out, size_t n, stack_order_t order){
+    assert(stack);
+
+    fstack_t *fstack = (fstack_t*)stack;
+    size_t k = n < fstack->top ? n : fstack->top;
+
+    fstack->top -= k;
+    STACK_STATS_POP(stack, k);
+
+    if(out && k){
+        char *src = ((char*)fstack->data)+(fstack->top * stack->size);
+
+        if(order == STACK_ORDER_BOTTOM_UP){
+            memcpy(out, src, k * stack->size);
+        }else{
+            for(size_t i = 0; i < k; i++)
+                memcpy((char*)out + i * stack->size, src + (k - 1 - i) * stack->size, stack->size);
+        }
+    }
+
+    fstack_auto_trim(fstack);
+    return k;
+}
+
+static void* fstack_emplace(stack_t* stack, stack_error_t* err){
+    assert(stack && err);
+
+    fstack_t *fstack = (fstack_t*)stack;
+
+    if(fstack->top == fstack->length){
+        STACK_STATS_PUSH_FAILED(stack);
+        *err = STACK_ERR_FULL;
         return NULL;
     }
-    
+
+    STACK_STATS_PUSH(stack, 1);
+    void *slot = ((char*)fstack->data)+(fstack->top++ * stack->size);
+    fstack_touch(fstack);
+    fstack_rearm_trim(fstack);
+
+    return slot;
+}
+
+//L'element reste en place dans le tableau jusqu'au prochain push
+static void* fstack_pop_view(stack_t* stack){
+    assert(stack);
+
     void *res = fstack_peek(stack);
-    
-    if (!res){
-        fprintf(stderr, "[!] fstack_pop : unable to pop, stack is empty\n");
-        return NULL;
+    if(res){
+        ((fstack_t*)stack)->top--;
+        STACK_STATS_POP(stack, 1);
     }
 
+    return res;
+}
+
+static size_t fstack_count(stack_t* stack){
+    assert(stack);
+    return ((fstack_t*)stack)->top;
+}
+
+//Les elements retires restent dans le tableau : seul top recule, en O(1) (sauf trim automatique)
+static void fstack_truncate(stack_t* stack, size_t count){
+    assert(stack && count <= ((fstack_t*)stack)->top);
+
+    STACK_STATS_POP(stack, ((fstack_t*)stack)->top - count);
+    ((fstack_t*)stack)->top = count;
+    fstack_auto_trim((fstack_t*)stack);
+}
+
+static void* fstack_at(stack_t* stack, size_t depth){
+    assert(stack);
+
     fstack_t *fstack = (fstack_t*)stack;
-    fstack->top--;
+    if (depth >= fstack->top) return NULL;
 
-    if(popped) 
-        memcpy(popped, res, stack->size);
+    return ((char*)fstack->data) + (fstack->top - 1 - depth) * stack->size;
+}
 
-    return popped;
+static stack_error_t fstack_foreach(stack_t* stack, stack_order_t order, stack_visitor_t visit, void* ctx){
+    assert(stack && visit);
+
+    fstack_t *fstack = (fstack_t*)stack;
+    size_t count = fstack->top;
+
+    for (size_t i = 0; i < count; i++){
+        size_t index = order == STACK_ORDER_BOTTOM_UP ? i : count - 1 - i;
+        if (!visit(((char*)fstack->data) + index * stack->size, ctx)) break;
+    }
+
+    return STACK_OK;
 }
 
-static bool fstack_is_empty(stack_t* stack){
-    if(!stack){
-        fprintf(stderr, "[!] fstack_is_empty : unable to check if stack is empty, given stack pointer is NULL\n");
-        return true;
+static void* fstack_find(stack_t* stack, const void* val){
+    assert(stack && val);
+
+    fstack_t *fstack = (fstack_t*)stack;
+    size_t index = stack_search_last(fstack->data, fstack->top, stack->size, val);
+
+    return index == STACK_SEARCH_NOT_FOUND ? NULL : ((char*)fstack->data) + index * stack->size;
+}
+
+//Le tableau est contigu : un seul fwrite
+static stack_error_t fstack_save(stack_t* stack, FILE* file){
+    assert(stack && file);
+
+    fstack_t *fstack = (fstack_t*)stack;
+
+    if (fwrite(fstack->data, stack->size, fstack->top, file) != fstack->top)
+        return STACK_ERR_IO;
+
+    return STACK_OK;
+}
+
+//Les elements sont lus directement a leur place, top n'avance qu'une fois la lecture terminee
+static stack_error_t fstack_load(stack_t* stack, FILE* file, size_t count){
+    assert(stack && file);
+
+    fstack_t *fstack = (fstack_t*)stack;
+
+    if (count > fstack->length - fstack->top){
+        STACK_STATS_PUSH_FAILED(stack);
+        return STACK_ERR_FULL;
     }
 
-    return ((fstack_t*)stack)->top == 0;
+    if (fread(((char*)fstack->data)+(fstack->top * stack->size), stack->size, count, file) != count)
+        return STACK_ERR_IO;
+
+    fstack->top += count;
+    fstack_touch(fstack);
+    STACK_STATS_PUSH(stack, count);
+    fstack_rearm_trim(fstack);
+
+    return STACK_OK;
+}
+
+// Versions de push et pop specialisees pour les tailles d'element courantes
+#define FSTACK_SIZED_OPS(N)                                                         \
+    static stack_error_t fstack_push_##N(stack_t* stack, void* val){                \
+        return fstack_push_sized(stack, val, N);                                    \
+    }                                                                               \
+    static stack_error_t fstack_pop_##N(stack_t* stack, void* popped){              \
+        return fstack_pop_sized(stack, popped, N);                                  \
+    }
+
+FSTACK_SIZED_OPS(1)
+FSTACK_SIZED_OPS(2)
+FSTACK_SIZED_OPS(4)
+FSTACK_SIZED_OPS(8)
+FSTACK_SIZED_OPS(16)
+FSTACK_SIZED_OPS(32)
+FSTACK_SIZED_OPS(64)
+
+static const struct {
+    size_t size;
+    stack_error_t (*push)(stack_t* self, void* val);
+    stack_error_t (*pop)(stack_t* self, void* popped);
+} fstack_sized_ops[] = {
+    {1, fstack_push_1, fstack_pop_1},
+    {2, fstack_push_2, fstack_pop_2},
+    {4, fstack_push_4, fstack_pop_4},
+    {8, fstack_push_8, fstack_pop_8},
+    {16, fstack_push_16, fstack_pop_16},
+    {32, fstack_push_32, fstack_pop_32},
+    {64, fstack_push_64, fstack_pop_64},
+};
+
+//Remplace push et pop par leur version specialisee si la taille d'element en a une
+static void fstack_select_sized_ops(stack_t* stack){
+    for (size_t i = 0; i < sizeof(fstack_sized_ops) / sizeof(fstack_sized_ops[0]); i++){
+        if (fstack_sized_ops[i].size != stack->size) continue;
+
+        stack->push = fstack_sized_ops[i].push;
+        stack->pop = fstack_sized_ops[i].pop;
+        return;
+    }
 }
@@ -3,14 +3,40 @@
 
 #include "stack.h"
 
+// Les cinq premiers champs sont partages avec gstack_t (voir tstack.h)
+// Le tableau suit l'en-tete dans la meme zone memoire (une seule allocation, ou la zone de stack_init_in)
+///@param high_water: Le sommet le plus haut depuis la derniere liberation : les pages au-dela n'ont pas ete touchees
+///                    (ou ont deja ete rendues), seul [0, high_water[ peut etre rendu par un trim
+///@param bytes: La taille du tableau en octets
+///@param locked: Le tableau est verrouille en memoire (mlock)
+///@param trim: La politique de trim automatique
+///@param trim_below: Un pop qui fait passer top sous trim_below rend les pages au-dessus du sommet (0 = jamais)
+///@param trim_mark: Apres un trim, le seuil porte sur trim_mark elements, un push au-dela le rearme sur tout le tableau (SIZE_MAX = aucune page rendue)
 typedef struct _fstack_t{
     stack_t base;
     void *data;
     size_t top;
     size_t length;
+    size_t high_water;
+    size_t bytes;
+    bool locked;
+    stack_trim_policy_t trim;
+    size_t trim_below;
+    size_t trim_mark;
 } fstack_t;
 
-int fstack_init(fstack_t* stack, fstack_config_t config);
+// La taille de l'en-tete, arrondie pour que le tableau qui le suit soit aligne comme malloc
+#define FSTACK_HEADER_BYTES ((sizeof(fstack_t) + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1))
+
+///@brief Retourne le nombre d'octets de la zone qui contient l'en-tete et le tableau d'une pile fixe
+///@return 0 si le tableau ne tient pas dans un size_t
+///@note La zone doit commencer a une adresse alignee sur _Alignof(max_align_t)
+size_t fstack_storage_bytes(fstack_config_t config);
+
+///@brief Initialise une pile fixe au debut d'une zone de fstack_storage_bytes(config) octets
+///@param zeroed: La zone est deja a zero (calloc) : le tableau n'est pas efface une deuxieme fois
+///@note La zone est liberee par destroy avec config.allocator
+int fstack_init(fstack_t* stack, fstack_config_t config, bool zeroed);
 
 
 #endif // __FSTACK_H__
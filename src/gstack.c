@@ -0,0 +1,359 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "stack.h"
+#include "gstack.h"
+#include "alloc.h"
+#include "stats.h"
+#include "search.h"
+#include "trim.h"
+
+static void gstack_destroy(stack_t** stack_ptr);
+static stack_error_t gstack_push(stack_t* stack, void* val);
+static void* gstack_peek(stack_t* stack);
+static stack_error_t gstack_pop(stack_t* stack, void* popped);
+static bool gstack_is_empty(stack_t* stack);
+static stack_error_t gstack_push_n(stack_t* stack, const void* vals, size_t n);
+static size_t gstack_pop_n(stack_t* stack, void* out, size_t n, stack_order_t order);
+static void* gstack_emplace(stack_t* stack, stack_error_t* err);
+static void* gstack_pop_view(stack_t* stack);
+static size_t gstack_count(stack_t* stack);
+static void gstack_truncate(stack_t* stack, size_t count);
+static void* gstack_at(stack_t* stack, size_t depth);
+static stack_error_t gstack_foreach(stack_t* stack, stack_order_t order, stack_visitor_t visit, void* ctx);
+static void* gstack_find(stack_t* stack, const void* val);
+static stack_error_t gstack_save(stack_t* stack, FILE* file);
+static stack_error_t gstack_load(stack_t* stack, FILE* file, size_t count);
+static size_t gstack_shrink(stack_t* stack);
+
+int gstack_init(gstack_t* stack, gstack_config_t config){
+    if (!stack) return (fprintf(stderr, "[!] gstack_init : invalid stack pointer\n"), -1);
+    if (config.size == 0) return (fprintf(stderr, "[!] gstack_init : invalid config size : size must be > 0\n"), -1);
+
+    size_t initial_length = config.initial_length ? config.initial_length : GSTACK_DEFAULT_INITIAL_LENGTH;
+    double growth_factor = config.growth_factor != 0 ? config.growth_factor : GSTACK_DEFAULT_GROWTH_FACTOR;
+
+    if (growth_factor <= 1.0) return (fprintf(stderr, "[!] gstack_init : invalid config growth_factor : growth_factor must be > 1\n"), -1);
+    if (config.max_length && initial_length > config.max_length) initial_length = config.max_length;
+    if (initial_length > SIZE_MAX / config.size) return (fprintf(stderr, "[!] gstack_init : invalid config initial_length : buffer is too large\n"), -1);
+    if (!stack_trim_policy_check(&config.trim)) return (fprintf(stderr, "[!] gstack_init : invalid config trim : low_watermark must be in [0, 1[ and low_watermark * headroom < 1\n"), -1);
+
+    memset(stack, 0, sizeof(*stack));
+
+    stack->base = (stack_t){
+        .type = STACK_TYPE_GROWABLE,
+        .size = config.size,
+        .allocator = config.allocator,
+        .destroy = gstack_destroy,
+        .push = gstack_push,
+        .peek = gstack_peek,
+        .pop = gstack_pop,
+        .is_empty = gstack_is_empty,
+        .push_n = gstack_push_n,
+        .pop_n = gstack_pop_n,
+        .emplace = gstack_emplace,
+        .pop_view = gstack_pop_view,
+        .count = gstack_count,
+        .truncate = gstack_truncate,
+        .at = gstack_at,
+        .foreach = gstack_foreach,
+        .find = gstack_find,
+        .save = gstack_save,
+        .load = gstack_load,
+        .shrink = gstack_shrink
+    };
+
+    stack->data = stack_mem_alloc(config.allocator, initial_length * config.size);
+    if (!stack->data) return (perror("malloc failed"), -1);
+    STACK_STATS_ALLOC(stack, initial_length * config.size);
+
+    stack->top = 0;
+    stack->length = initial_length;
+    stack->max_length = config.max_length;
+    stack->growth_factor = growth_factor;
+    stack->trim = config.trim;
+    stack->trim_below = stack_trim_threshold(&config.trim, initial_length, config.size);
+
+    return 0;
+}
+
+static void gstack_destroy(stack_t** stack){
+    assert(stack && *stack);
+
+    const stack_allocator_t *allocator = (*stack)->allocator;
+    stack_mem_free(allocator, ((gstack_t*)*stack)->data);
+    stack_mem_free(allocator, *stack);
+    *stack = NULL;
+}
+
+//Agrandit le tableau d'un facteur growth_factor jusqu'a contenir au moins needed elements (au plus max_length)
+//Un echec compte comme un ajout refuse : gstack_reserve n'est appele que pour ajouter des elements
+static stack_error_t gstack_reserve(gstack_t* gstack, size_t needed){
+    if (needed <= gstack->length) return STACK_OK;
+
+    size_t limit = SIZE_MAX / gstack->base.size;
+    if (gstack->max_length && gstack->max_length < limit) limit = gstack->max_length;
+
+    if (needed > limit){
+        STACK_STATS_PUSH_FAILED(gstack);
+        return STACK_ERR_FULL;
+    }
+
+    size_t new_length = gstack->length;
+    while (new_length < needed){
+        double wanted = (double)new_length * gstack->growth_factor;
+        size_t next = wanted >= (double)limit ? limit : (size_t)wanted;
+        new_length = next > new_length ? next : new_length + 1;
+    }
+
+    void *data = stack_mem_realloc(gstack->base.allocator, gstack->data, new_length * gstack->base.size);
+    if (!data){
+        STACK_STATS_PUSH_FAILED(gstack);
+        return STACK_ERR_NO_MEMORY;
+    }
+
+    STACK_STATS_ALLOC(gstack, (new_length - gstack->length) * gstack->base.size);
+    gstack->data = data;
+    gstack->length = new_length;
+    gstack->trim_below = stack_trim_threshold(&gstack->trim, new_length, gstack->base.size);
+
+    return STACK_OK;
+}
+
+//Reduit le tableau a keep elements (au moins top et au moins 1), retourne le nombre d'octets rendus
+static size_t gstack_resize_down(gstack_t* gstack, size_t keep){
+    if (keep < gstack->top) keep = gstack->top;
+    if (keep == 0) keep = 1;
+    if (keep >= gstack->length) return 0;
+
+    //un realloc qui echoue laisse le tableau intact : la pile reste utilisable, rien n'est rendu
+    void *data = stack_mem_realloc(gstack->base.allocator, gstack->data, keep * gstack->base.size);
+    if (!data) return 0;
+
+    size_t bytes = (gstack->length - keep) * gstack->base.size;
+    STACK_STATS_FREE(gstack, bytes);
+    STACK_STATS_TRIM(gstack, bytes);
+
+    gstack->data = data;
+    gstack->length = keep;
+    gstack->trim_below = stack_trim_threshold(&gstack->trim, keep, gstack->base.size);
+
+    return bytes;
+}
+
+//Applique la politique de trim apres un retrait (jamais apres pop_view : l'element retire doit rester lisible)
+static inline void gstack_auto_trim(gstack_t* gstack){
+    if (gstack->top < gstack->trim_below)
+        gstack_resize_down(gstack, stack_trim_keep(&gstack->trim, gstack->top));
+}
+
+static stack_error_t gstack_push(stack_t* stack, void* val){
+    assert(stack && val);
+
+    gstack_t *gstack = (gstack_t*)stack;
+
+    if (gstack->top == gstack->length){
+        stack_error_t err = gstack_reserve(gstack, gstack->top + 1);
+        if (err) return err;
+    }
+
+    void* dest = ((char*)gstack->data)+(gstack->top * stack->size);
+    memcpy(dest, val, stack->size);
+
+    gstack->top++;
+    STACK_STATS_PUSH(stack, 1);
+
+    return STACK_OK;
+}
+
+static void* gstack_peek(stack_t* stack){
+    assert(stack);
+
+    gstack_t *gstack = (gstack_t*)stack;
+
+    if(gstack_is_empty(stack))
+        return NULL;
+
+    return ((char*)gstack->data)+(gstack->top - 1) * stack->size;
+}
+
+static stack_error_t gstack_pop(stack_t* stack, void* popped){
+    assert(stack);
+
+    void *res = gstack_peek(stack);
+    if (!res) return STACK_ERR_EMPTY;
+
+    gstack_t *gstack = (gstack_t*)stack;
+    gstack->top--;
+    STACK_STATS_POP(stack, 1);
+
+    if(popped)
+        memcpy(popped, res, stack->size);
+
+    gstack_auto_trim(gstack);
+    return STACK_OK;
+}
+
+static bool gstack_is_empty(stack_t* stack){
+    assert(stack);
+    return ((gstack_t*)stack)->top == 0;
+}
+
+static stack_error_t gstack_push_n(stack_t* stack, const void* vals, size_t n){
+    assert(stack && vals);
+
+    gstack_t *gstack = (gstack_t*)stack;
+
+    if (n > SIZE_MAX - gstack->top){
+        STACK_STATS_PUSH_FAILED(stack);
+        return STACK_ERR_FULL;
+    }
+
+    stack_error_t err = gstack_reserve(gstack, gstack->top + n);
+    if (err) return err;
+
+    memcpy(((char*)gstack->data)+(gstack->top * stack->size), vals, n * stack->size);
+    gstack->top += n;
+    STACK_STATS_PUSH(stack, n);
+
+    return STACK_OK;
+}
+
+static size_t gstack_pop_n(stack_t* stack, void* out, size_t n, stack_order_t order){
+    assert(stack);
+
+    gstack_t *gstack = (gstack_t*)stack;
+    size_t k = n < gstack->top ? n : gstack->top;
+
+    gstack->top -= k;
+    STACK_STATS_POP(stack, k);
+
+    if(out && k){
+        char *src = ((char*)gstack->data)+(gstack->top * stack->size);
+
+        if(order == STACK_ORDER_BOTTOM_UP){
+            memcpy(out, src, k * stack->size);
+        }else{
+            for(size_t i = 0; i < k; i++)
+                memcpy((char*)out + i * stack->size, src + (k - 1 - i) * stack->size, stack->size);
+        }
+    }
+
+    gstack_auto_trim(gstack);
+    return k;
+}
+
+static void* gstack_emplace(stack_t* stack, stack_error_t* err){
+    assert(stack && err);
+
+    gstack_t *gstack = (gstack_t*)stack;
+
+    if (gstack->top == gstack->length && (*err = gstack_reserve(gstack, gstack->top + 1)))
+        return NULL;
+
+    STACK_STATS_PUSH(stack, 1);
+    return ((char*)gstack->data)+(gstack->top++ * stack->size);
+}
+
+//L'element reste en place dans le tableau jusqu'au prochain push (le tableau n'est pas reduit ici)
+static void* gstack_pop_view(stack_t* stack){
+    assert(stack);
+
+    void *res = gstack_peek(stack);
+    if(res){
+        ((gstack_t*)stack)->top--;
+        STACK_STATS_POP(stack, 1);
+    }
+
+    return res;
+}
+
+static size_t gstack_count(stack_t* stack){
+    assert(stack);
+    return ((gstack_t*)stack)->top;
+}
+
+//Seul top recule, en O(1) (le tableau n'est reduit que par la politique de trim)
+static void gstack_truncate(stack_t* stack, size_t count){
+    assert(stack && count <= ((gstack_t*)stack)->top);
+
+    STACK_STATS_POP(stack, ((gstack_t*)stack)->top - count);
+    ((gstack_t*)stack)->top = count;
+    gstack_auto_trim((gstack_t*)stack);
+}
+
+static size_t gstack_shrink(stack_t* stack){
+    assert(stack);
+    return gstack_resize_down((gstack_t*)stack, 0);
+}
+
+static void* gstack_at(stack_t* stack, size_t depth){
+    assert(stack);
+
+    gstack_t *gstack = (gstack_t*)stack;
+    if (depth >= gstack->top) return NULL;
+
+    return ((char*)gstack->data) + (gstack->top - 1 - depth) * stack->size;
+}
+
+static stack_error_t gstack_foreach(stack_t* stack, stack_order_t order, stack_visitor_t visit, void* ctx){
+    assert(stack && visit);
+
+    gstack_t *gstack = (gstack_t*)stack;
+    size_t count = gstack->top;
+
+    for (size_t i = 0; i < count; i++){
+        size_t index = order == STACK_ORDER_BOTTOM_UP ? i : count - 1 - i;
+        if (!visit(((char*)gstack->data) + index * stack->size, ctx)) break;
+    }
+
+    return STACK_OK;
+}
+
+static void* gstack_find(stack_t* stack, const void* val){
+    assert(stack && val);
+
+    gstack_t *gstack = (gstack_t*)stack;
+    size_t index = stack_search_last(gstack->data, gstack->top, stack->size, val);
+
+    return index == STACK_SEARCH_NOT_FOUND ? NULL : ((char*)gstack->data) + index * stack->size;
+}
+
+//Le tableau est contigu : un seul fwrite
+static stack_error_t gstack_save(stack_t* stack, FILE* file){
+    assert(stack && file);
+
+    gstack_t *gstack = (gstack_t*)stack;
+
+    if (fwrite(gstack->data, stack->size, gstack->top, file) != gstack->top)
+        return STACK_ERR_IO;
+
+    return STACK_OK;
+}
+
+//Reserve la place de tous les elements puis les lit directement dans le tableau
+static stack_error_t gstack_load(stack_t* stack, FILE* file, size_t count){
+    assert(stack && file);
+
+    gstack_t *gstack = (gstack_t*)stack;
+
+    if (count > SIZE_MAX - gstack->top){
+        STACK_STATS_PUSH_FAILED(stack);
+        return STACK_ERR_FULL;
+    }
+
+    stack_error_t err = gstack_reserve(gstack, gstack->top + count);
+    if (err) return err;
+
+    if (fread(((char*)gstack->data)+(gstack->top * stack->size), stack->size, count, file) != count)
+        return STACK_ERR_IO;
+
+    gstack->top += count;
+    STACK_STATS_PUSH(stack, count);
+
+    return STACK_OK;
+}
@@ -0,0 +1,26 @@
+#ifndef __GSTACK_H__
+#define __GSTACK_H__
+
+#include "stack.h"
+
+// Les cinq premiers champs ont la meme disposition que fstack_t
+///@param high_water: Mis a jour par les push de tstack.h, inutilise par la pile extensible (son trim reduit le tableau)
+///@param max_length: La capacite maximale (0 = pas de limite)
+///@param growth_factor: Le facteur d'agrandissement du tableau
+///@param trim: La politique de trim automatique
+///@param trim_below: Un pop qui fait passer top sous trim_below reduit le tableau (0 = jamais)
+typedef struct _gstack_t{
+    stack_t base;
+    void *data;
+    size_t top;
+    size_t length;
+    size_t high_water;
+    size_t max_length;
+    double growth_factor;
+    stack_trim_policy_t trim;
+    size_t trim_below;
+} gstack_t;
+
+int gstack_init(gstack_t* stack, gstack_config_t config);
+
+#endif // __GSTACK_H__
@@ -0,0 +1,466 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "stack.h"
+#include "istack.h"
+#include "alloc.h"
+#include "stats.h"
+
+#define ISLOT_KEY(slot) ((char*)(slot) + sizeof(islot_t))
+
+static void istack_destroy(stack_t** stack_ptr);
+static stack_error_t istack_push(stack_t* stack, void* val);
+static void* istack_peek(stack_t* stack);
+static stack_error_t istack_pop(stack_t* stack, void* popped);
+static bool istack_is_empty(stack_t* stack);
+static stack_error_t istack_push_n(stack_t* stack, const void* vals, size_t n);
+static size_t istack_pop_n(stack_t* stack, void* out, size_t n, stack_order_t order);
+static void* istack_pop_view(stack_t* stack);
+static size_t istack_count(stack_t* stack);
+static stack_error_t istack_save(stack_t* stack, FILE* file);
+static void istack_truncate(stack_t* stack, size_t count);
+static void* istack_at(stack_t* stack, size_t depth);
+static stack_error_t istack_foreach(stack_t* stack, stack_order_t order, stack_visitor_t visit, void* ctx);
+static void* istack_find(stack_t* stack, const void* val);
+static bool istack_contains(stack_t* stack, const void* val);
+static size_t istack_shrink(stack_t* stack);
+static stack_error_t istack_add(istack_t* istack, const void* key);
+static void istack_remove(istack_t* istack, const void* key);
+
+typedef struct {
+    istack_t *istack;
+    stack_error_t err;
+} istack_add_ctx_t;
+
+//Ajoute a l'index les elements deja presents dans la pile (fichier d'une pile projetee rouvert)
+static bool istack_add_visit(void* elem, void* ctx){
+    istack_add_ctx_t *add = ctx;
+    add->err = istack_add(add->istack, elem);
+    return add->err == STACK_OK;
+}
+
+int istack_init(istack_t* stack, istack_config_t config){
+    if (!stack) return (fprintf(stderr, "[!] istack_init : invalid stack pointer\n"), -1);
+    if (config.type == STACK_TYPE_CONCURRENT || config.type == STACK_TYPE_WORK_STEALING || config.type == STACK_TYPE_INDEXED)
+        return (fprintf(stderr, "[!] istack_init : invalid config type : this stack type cannot be indexed\n"), -1);
+    if (config.bloom_counters > (SIZE_MAX >> 1) + 1)
+        return (fprintf(stderr, "[!] istack_init : invalid config bloom_counters : too many counters\n"), -1);
+
+    size_t wanted = config.initial_capacity ? config.initial_capacity : ISTACK_DEFAULT_INITIAL_CAPACITY;
+    if (wanted > SIZE_MAX / 4)
+        return (fprintf(stderr, "[!] istack_init : invalid config initial_capacity : capacity is too large\n"), -1);
+
+    memset(stack, 0, sizeof(*stack));
+
+    stack_t *inner = stack_create(config.type, config.config);
+    if (!inner) return -1;
+
+    if (inner->size == 0){
+        fprintf(stderr, "[!] istack_init : invalid config type : records of variable size cannot be indexed\n");
+        inner->destroy(&inner);
+        return -1;
+    }
+
+    stack->base = (stack_t){
+        .type = STACK_TYPE_INDEXED,
+        .size = inner->size,
+        .allocator = config.allocator,
+        .destroy = istack_destroy,
+        .push = istack_push,
+        .peek = istack_peek,
+        .pop = istack_pop,
+        .is_empty = istack_is_empty,
+        .push_n = inner->push_n ? istack_push_n : NULL,
+        .pop_n = inner->pop_n ? istack_pop_n : NULL,
+        .pop_view = inner->pop_view ? istack_pop_view : NULL,
+        .count = istack_count,
+        .save = inner->save ? istack_save : NULL,
+        .truncate = istack_truncate,
+        .at = istack_at,
+        .foreach = istack_foreach,
+        .find = inner->find ? istack_find : NULL,
+        .contains = istack_contains,
+        .shrink = inner->shrink ? istack_shrink : NULL
+    };
+
+    stack->inner = inner;
+    stack->slot_stride = (sizeof(islot_t) + inner->size + _Alignof(islot_t) - 1) & ~(_Alignof(islot_t) - 1);
+
+    //au plus une case sur deux est utilisee
+    stack->capacity = 16;
+    while (stack->capacity < wanted * 2) stack->capacity <<= 1;
+
+    if (stack->capacity > SIZE_MAX / stack->slot_stride){
+        fprintf(stderr, "[!] istack_init : invalid config initial_capacity : index is too large\n");
+        inner->destroy(&stack->inner);
+        return -1;
+    }
+
+    stack->slots = stack_mem_calloc(config.allocator, stack->capacity, stack->slot_stride);
+
+    if (config.bloom_counters){
+        size_t counters = 1;
+        while (counters < config.bloom_counters) counters <<= 1;
+        stack->bloom = stack_mem_calloc(config.allocator, counters, sizeof(uint8_t));
+        stack->bloom_mask = counters - 1;
+    }
+
+    istack_add_ctx_t add = {.istack = stack, .err = STACK_OK};
+    if (stack->slots && (stack->bloom || !config.bloom_counters) && inner->count(inner))
+        inner->foreach(inner, STACK_ORDER_BOTTOM_UP, istack_add_visit, &add);
+
+    if (!stack->slots || (config.bloom_counters && !stack->bloom) || add.err){
+        perror("malloc failed");
+        stack_mem_free(config.allocator, stack->slots);
+        stack_mem_free(config.allocator, stack->bloom);
+        inner->destroy(&stack->inner);
+        return -1;
+    }
+
+    STACK_STATS_ALLOC(stack, stack->capacity * stack->slot_stride);
+    if (stack->bloom) STACK_STATS_ALLOC(stack, stack->bloom_mask + 1);
+    STACK_STATS_SET_DEPTH(stack, inner->count(inner));
+
+    return 0;
+}
+
+static void istack_destroy(stack_t** stack_ptr){
+    assert(stack_ptr && *stack_ptr);
+    istack_t *stack = (istack_t*)*stack_ptr;
+
+    stack->inner->destroy(&stack->inner);
+    stack_mem_free(stack->base.allocator, stack->slots);
+    stack_mem_free(stack->base.allocator, stack->bloom);
+
+    stack_mem_free(stack->base.allocator, stack);
+    *stack_ptr = NULL;
+}
+
+//Hash de 64 bits des size octets de key : melange 8 octets par 8 octets puis finalisation de murmur3
+static uint64_t istack_hash(const void* key, size_t size){
+    const unsigned char *bytes = key;
+    uint64_t h = 0x9e3779b97f4a7c15ull ^ size;
+
+    for (; size >= 8; size -= 8, bytes += 8){
+        uint64_t k;
+        memcpy(&k, bytes, 8);
+        h = (h ^ k) * 0xff51afd7ed558ccdull;
+        h ^= h >> 32;
+    }
+
+    if (size){
+        uint64_t k = 0;
+        memcpy(&k, bytes, size);
+        h = (h ^ k) * 0xff51afd7ed558ccdull;
+    }
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+static inline islot_t* istack_slot(istack_t* istack, size_t index){
+    return (islot_t*)(istack->slots + index * istack->slot_stride);
+}
+
+//Retourne la case de key, ou la case vide ou l'inserer
+static islot_t* istack_probe(istack_t* istack, const void* key, uint64_t hash){
+    size_t mask = istack->capacity - 1;
+
+    for (size_t i = hash & mask; ; i = (i + 1) & mask){
+        islot_t *slot = istack_slot(istack, i);
+        if (slot->count == 0) return slot;
+        if (slot->hash == hash && memcmp(ISLOT_KEY(slot), key, istack->base.size) == 0) return slot;
+    }
+}
+
+//Double la table et y replace toutes les cles
+static stack_error_t istack_grow(istack_t* istack){
+    if (istack->capacity > SIZE_MAX / 2 / istack->slot_stride) return STACK_ERR_NO_MEMORY;
+
+    char *old = istack->slots;
+    size_t old_capacity = istack->capacity;
+
+    char *slots = stack_mem_calloc(istack->base.allocator, old_capacity * 2, istack->slot_stride);
+    if (!slots) return STACK_ERR_NO_MEMORY;
+
+    istack->slots = slots;
+    istack->capacity = old_capacity * 2;
+    STACK_STATS_ALLOC(istack, istack->capacity * istack->slot_stride);
+
+    for (size_t i = 0; i < old_capacity; i++){
+        islot_t *slot = (islot_t*)(old + i * istack->slot_stride);
+        if (slot->count) memcpy(istack_probe(istack, ISLOT_KEY(slot), slot->hash), slot, istack->slot_stride);
+    }
+
+    stack_mem_free(istack->base.allocator, old);
+    STACK_STATS_FREE(istack, old_capacity * istack->slot_stride);
+
+    return STACK_OK;
+}
+
+// Le filtre de Bloom utilise deux compteurs par cle, tires des 32 bits hauts du hash (les bits bas choisissent la case)
+static inline size_t istack_bloom_index(istack_t* istack, uint64_t hash, int i){
+    uint32_t h1 = (uint32_t)(hash >> 32), h2 = (uint32_t)(hash >> 16) | 1;
+    return (h1 + (size_t)i * h2) & istack->bloom_mask;
+}
+
+static void istack_bloom_update(istack_t* istack, uint64_t hash, int delta){
+    for (int i = 0; i < 2; i++){
+        uint8_t *counter = &istack->bloom[istack_bloom_index(istack, hash, i)];
+        if (*counter != UINT8_MAX) *counter = (uint8_t)(*counter + delta);
+    }
+}
+
+static stack_error_t istack_add(istack_t* istack, const void* key){
+    uint64_t hash = istack_hash(key, istack->base.size);
+    islot_t *slot = istack_probe(istack, key, hash);
+
+    if (slot->count){
+        slot->count++;
+        return STACK_OK;
+    }
+
+    if ((istack->distinct + 1) * 2 > istack->capacity){
+        if (istack_grow(istack)) return STACK_ERR_NO_MEMORY;
+        slot = istack_probe(istack, key, hash);
+    }
+
+    slot->hash = hash;
+    slot->count = 1;
+    memcpy(ISLOT_KEY(slot), key, istack->base.size);
+    istack->distinct++;
+
+    if (istack->bloom) istack_bloom_update(istack, hash, 1);
+
+    return STACK_OK;
+}
+
+//Une case videe est comblee en remontant les cles suivantes de la meme sequence de sondage (pas de marqueur de suppression)
+static void istack_remove(istack_t* istack, const void* key){
+    uint64_t hash = istack_hash(key, istack->base.size);
+    islot_t *slot = istack_probe(istack, key, hash);
+    assert(slot->count);
+
+    if (--slot->count) return;
+
+    istack->distinct--;
+    if (istack->bloom) istack_bloom_update(istack, hash, -1);
+
+    size_t mask = istack->capacity - 1;
+    size_t hole = (size_t)((char*)slot - istack->slots) / istack->slot_stride;
+
+    for (size_t i = (hole + 1) & mask; ; i = (i + 1) & mask){
+        islot_t *next = istack_slot(istack, i);
+        if (next->count == 0) break;
+
+        //la cle peut combler le trou si sa case d'origine n'est pas entre le trou et sa position
+        size_t home = next->hash & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)){
+            memcpy(istack_slot(istack, hole), next, istack->slot_stride);
+            hole = i;
+        }
+    }
+
+    istack_slot(istack, hole)->count = 0;
+}
+
+typedef struct {
+    istack_t *istack;
+    size_t remaining;
+} istack_remove_ctx_t;
+
+static bool istack_remove_visit(void* elem, void* ctx){
+    istack_remove_ctx_t *remove = ctx;
+    istack_remove(remove->istack, elem);
+    return --remove->remaining > 0;
+}
+
+//Retire de l'index les n elements au sommet de la pile (avant de les retirer de la pile)
+static void istack_remove_top(istack_t* istack, size_t n){
+    if (n == 0) return;
+
+    istack_remove_ctx_t remove = {.istack = istack, .remaining = n};
+    istack->inner->foreach(istack->inner, STACK_ORDER_TOP_DOWN, istack_remove_visit, &remove);
+}
+
+static stack_error_t istack_push(stack_t* stack, void* val){
+    assert(stack && val);
+
+    istack_t *istack = (istack_t*)stack;
+    stack_t *inner = istack->inner;
+
+    stack_error_t err = inner->push(inner, val);
+    if (!err && (err = istack_add(istack, val)))
+        inner->truncate(inner, inner->count(inner) - 1);
+
+    if (err){
+        STACK_STATS_PUSH_FAILED(stack);
+        return err;
+    }
+
+    STACK_STATS_PUSH(stack, 1);
+    return STACK_OK;
+}
+
+static void* istack_peek(stack_t* stack){
+    assert(stack);
+    stack_t *inner = ((istack_t*)stack)->inner;
+    return inner->peek(inner);
+}
+
+static stack_error_t istack_pop(stack_t* stack, void* popped){
+    assert(stack);
+
+    istack_t *istack = (istack_t*)stack;
+    stack_t *inner = istack->inner;
+
+    void *top = inner->peek(inner);
+    if (!top) return STACK_ERR_EMPTY;
+
+    istack_remove(istack, top);
+    inner->pop(inner, popped);
+    STACK_STATS_POP(stack, 1);
+
+    return STACK_OK;
+}
+
+static bool istack_is_empty(stack_t* stack){
+    assert(stack);
+    stack_t *inner = ((istack_t*)stack)->inner;
+    return inner->is_empty(inner);
+}
+
+//Les elements sont ajoutes a la pile en un seul appel puis a l'index :
+//si l'index ne peut pas s'agrandir, les elements non indexes sont retires de la pile
+static stack_error_t istack_push_n(stack_t* stack, const void* vals, size_t n){
+    assert(stack && vals);
+
+    istack_t *istack = (istack_t*)stack;
+    stack_t *inner = istack->inner;
+    size_t before = inner->count(inner);
+
+    stack_error_t err = inner->push_n(inner, vals, n);
+    size_t pushed = inner->count(inner) - before;
+
+    for (size_t i = 0; i < pushed; i++){
+        if (istack_add(istack, (const char*)vals + i * stack->size)){
+            inner->truncate(inner, before + i);
+            pushed = i;
+            err = STACK_ERR_NO_MEMORY;
+            break;
+        }
+    }
+
+    STACK_STATS_PUSH(stack, pushed);
+    if (err) STACK_STATS_PUSH_FAILED(stack);
+
+    return err;
+}
+
+static size_t istack_pop_n(stack_t* stack, void* out, size_t n, stack_order_t order){
+    assert(stack);
+
+    istack_t *istack = (istack_t*)stack;
+    stack_t *inner = istack->inner;
+
+    size_t count = inner->count(inner);
+    istack_remove_top(istack, n < count ? n : count);
+
+    size_t popped = inner->pop_n(inner, out, n, order);
+    STACK_STATS_POP(stack, popped);
+
+    return popped;
+}
+
+static void* istack_pop_view(stack_t* stack){
+    assert(stack);
+
+    istack_t *istack = (istack_t*)stack;
+    stack_t *inner = istack->inner;
+
+    void *top = inner->peek(inner);
+    if (!top) return NULL;
+
+    istack_remove(istack, top);
+    STACK_STATS_POP(stack, 1);
+
+    return inner->pop_view(inner);
+}
+
+static size_t istack_count(stack_t* stack){
+    assert(stack);
+    stack_t *inner = ((istack_t*)stack)->inner;
+    return inner->count(inner);
+}
+
+static stack_error_t istack_save(stack_t* stack, FILE* file){
+    assert(stack && file);
+    stack_t *inner = ((istack_t*)stack)->inner;
+    return inner->save(inner, file);
+}
+
+static void istack_truncate(stack_t* stack, size_t count){
+    assert(stack);
+
+    istack_t *istack = (istack_t*)stack;
+    stack_t *inner = istack->inner;
+    size_t removed = inner->count(inner) - count;
+
+    istack_remove_top(istack, removed);
+    inner->truncate(inner, count);
+    STACK_STATS_POP(stack, removed);
+}
+
+static void* istack_at(stack_t* stack, size_t depth){
+    assert(stack);
+    stack_t *inner = ((istack_t*)stack)->inner;
+    return inner->at(inner, depth);
+}
+
+static stack_error_t istack_foreach(stack_t* stack, stack_order_t order, stack_visitor_t visit, void* ctx){
+    assert(stack && visit);
+    stack_t *inner = ((istack_t*)stack)->inner;
+    return inner->foreach(inner, order, visit, ctx);
+}
+
+static void* istack_find(stack_t* stack, const void* val){
+    assert(stack && val);
+
+    istack_t *istack = (istack_t*)stack;
+    if (!istack_contains(stack, val)) return NULL;
+
+    return istack->inner->find(istack->inner, val);
+}
+
+static bool istack_contains(stack_t* stack, const void* val){
+    assert(stack && val);
+
+    istack_t *istack = (istack_t*)stack;
+    uint64_t hash = istack_hash(val, stack->size);
+
+    if (istack->bloom){
+        for (int i = 0; i < 2; i++)
+            if (istack->bloom[istack_bloom_index(istack, hash, i)] == 0) return false;
+    }
+
+    return istack_probe(istack, val, hash)->count != 0;
+}
+
+//Seule la pile contenue est reduite : la table garde sa taille (elle ne grandit qu'avec le nombre de valeurs distinctes)
+static size_t istack_shrink(stack_t* stack){
+    assert(stack);
+
+    istack_t *istack = (istack_t*)stack;
+    size_t bytes = istack->inner->shrink(istack->inner);
+    STACK_STATS_TRIM(stack, bytes);
+
+    return bytes;
+}
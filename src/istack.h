@@ -0,0 +1,37 @@
+#ifndef __ISTACK_H__
+#define __ISTACK_H__
+
+#include <stdint.h>
+
+#include "stack.h"
+
+// Une case de l'index, suivie de la cle (les size octets d'un element)
+///@param hash: Le hash de la cle
+///@param count: Le nombre d'elements de la pile egaux a la cle (0 = case vide)
+typedef struct _islot_t{
+    uint64_t hash;
+    size_t count;
+} islot_t;
+
+// L'index est une table de hachage a adressage ouvert (sondage lineaire), au plus a moitie pleine
+///@param inner: La pile qui stocke les elements, toutes les operations lui sont deleguees
+///@param slots: Les capacity cases de l'index, de slot_stride octets chacune
+///@param capacity: Le nombre de cases (puissance de 2)
+///@param slot_stride: La taille d'une case (entete + cle, alignee)
+///@param distinct: Le nombre de cases utilisees (valeurs distinctes dans la pile)
+///@param bloom: Les compteurs du filtre de Bloom (NULL si desactive), un compteur sature n'est plus decremente
+///@param bloom_mask: Le nombre de compteurs - 1
+typedef struct _istack_t{
+    stack_t base;
+    stack_t *inner;
+    char *slots;
+    size_t capacity;
+    size_t slot_stride;
+    size_t distinct;
+    uint8_t *bloom;
+    size_t bloom_mask;
+} istack_t;
+
+int istack_init(istack_t* stack, istack_config_t config);
+
+#endif // __ISTACK_H__
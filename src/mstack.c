@@ -0,0 +1,402 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "stack.h"
+#include "mstack.h"
+#include "alloc.h"
+#include "stats.h"
+#include "search.h"
+
+static void mstack_destroy(stack_t** stack_ptr);
+static stack_error_t mstack_push(stack_t* stack, void* val);
+static void* mstack_peek(stack_t* stack);
+static stack_error_t mstack_pop(stack_t* stack, void* popped);
+static bool mstack_is_empty(stack_t* stack);
+static stack_error_t mstack_push_n(stack_t* stack, const void* vals, size_t n);
+static size_t mstack_pop_n(stack_t* stack, void* out, size_t n, stack_order_t order);
+static void* mstack_emplace(stack_t* stack, stack_error_t* err);
+static void* mstack_pop_view(stack_t* stack);
+static size_t mstack_count(stack_t* stack);
+static void mstack_truncate(stack_t* stack, size_t count);
+static void* mstack_at(stack_t* stack, size_t depth);
+static stack_error_t mstack_foreach(stack_t* stack, stack_order_t order, stack_visitor_t visit, void* ctx);
+static void* mstack_find(stack_t* stack, const void* val);
+static stack_error_t mstack_save(stack_t* stack, FILE* file);
+static stack_error_t mstack_load(stack_t* stack, FILE* file, size_t count);
+
+//Retourne la taille du fichier pour length elements (0 si elle depasse SIZE_MAX)
+static size_t mstack_file_bytes(size_t length, size_t size){
+    if (length > (SIZE_MAX - MSTACK_DATA_OFFSET) / size) return 0;
+    return MSTACK_DATA_OFFSET + length * size;
+}
+
+//Cree un nouveau fichier de pile vide de initial_length elements
+static int mstack_create_file(mstack_t* stack, mstack_config_t config){
+    size_t length = config.initial_length ? config.initial_length : MSTACK_DEFAULT_INITIAL_LENGTH;
+    size_t bytes = mstack_file_bytes(length, config.size);
+
+    if (!bytes) return (fprintf(stderr, "[!] mstack_init : invalid config initial_length : file is too large\n"), -1);
+    if (ftruncate(stack->fd, (off_t)bytes)) return (perror("ftruncate failed"), -1);
+
+    void *map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, stack->fd, 0);
+    if (map == MAP_FAILED) return (perror("mmap failed"), -1);
+
+    stack->header = map;
+    stack->mapped = bytes;
+    *stack->header = (mstack_header_t){
+        .magic = MSTACK_MAGIC,
+        .version = MSTACK_VERSION,
+        .size = config.size,
+        .top = 0,
+        .length = length
+    };
+
+    return 0;
+}
+
+//Projette un fichier de pile existant, sans lire les elements
+static int mstack_open_file(mstack_t* stack, mstack_config_t config, size_t file_bytes){
+    if (file_bytes < MSTACK_DATA_OFFSET) return (fprintf(stderr, "[!] mstack_init : invalid file : %s is not a stack file\n", config.path), -1);
+
+    void *map = mmap(NULL, file_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, stack->fd, 0);
+    if (map == MAP_FAILED) return (perror("mmap failed"), -1);
+
+    mstack_header_t *header = map;
+    const char *error = NULL;
+
+    if (header->magic != MSTACK_MAGIC) error = "not a stack file";
+    else if (header->version != MSTACK_VERSION) error = "unsupported file version";
+    else if (header->size != config.size) error = "element size does not match config size";
+    else if (header->top > header->length || mstack_file_bytes(header->length, config.size) == 0
+          || mstack_file_bytes(header->length, config.size) > file_bytes) error = "file is truncated or corrupted";
+
+    if (error){
+        fprintf(stderr, "[!] mstack_init : invalid file : %s : %s\n", config.path, error);
+        munmap(map, file_bytes);
+        return -1;
+    }
+
+    stack->header = header;
+    stack->mapped = file_bytes;
+
+    return 0;
+}
+
+int mstack_init(mstack_t* stack, mstack_config_t config){
+    if (!stack) return (fprintf(stderr, "[!] mstack_init : invalid stack pointer\n"), -1);
+    if (!config.path) return (fprintf(stderr, "[!] mstack_init : invalid config path : path is NULL\n"), -1);
+    if (config.size == 0) return (fprintf(stderr, "[!] mstack_init : invalid config size : size must be > 0\n"), -1);
+
+    memset(stack, 0, sizeof(*stack));
+
+    stack->base = (stack_t){
+        .type = STACK_TYPE_MAPPED,
+        .size = config.size,
+        .allocator = config.allocator,
+        .destroy = mstack_destroy,
+        .push = mstack_push,
+        .peek = mstack_peek,
+        .pop = mstack_pop,
+        .is_empty = mstack_is_empty,
+        .push_n = mstack_push_n,
+        .pop_n = mstack_pop_n,
+        .emplace = mstack_emplace,
+        .pop_view = mstack_pop_view,
+        .count = mstack_count,
+        .truncate = mstack_truncate,
+        .at = mstack_at,
+        .foreach = mstack_foreach,
+        .find = mstack_find,
+        .save = mstack_save,
+        .load = mstack_load
+    };
+
+    stack->fd = open(config.path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (stack->fd < 0) return (perror("open failed"), -1);
+
+    struct stat st;
+    if (fstat(stack->fd, &st)){
+        perror("fstat failed");
+        close(stack->fd);
+        return -1;
+    }
+
+    int err = st.st_size == 0
+        ? mstack_create_file(stack, config)
+        : mstack_open_file(stack, config, (size_t)st.st_size);
+
+    if (err){
+        close(stack->fd);
+        return -1;
+    }
+
+    stack->data = (char*)stack->header + MSTACK_DATA_OFFSET;
+    STACK_STATS_ALLOC(stack, stack->mapped);
+    STACK_STATS_SET_DEPTH(stack, stack->header->top);
+
+    return 0;
+}
+
+static void mstack_destroy(stack_t** stack){
+    assert(stack && *stack);
+
+    mstack_t *mstack = (mstack_t*)*stack;
+    munmap(mstack->header, mstack->mapped);
+    close(mstack->fd);
+
+    stack_mem_free((*stack)->allocator, *stack);
+    *stack = NULL;
+}
+
+//Double la capacite du fichier jusqu'a contenir au moins needed elements, puis agrandit la projection
+//Un echec compte comme un ajout refuse : mstack_reserve n'est appele que pour ajouter des elements
+static stack_error_t mstack_reserve(mstack_t* mstack, size_t needed){
+    size_t length = mstack->header->length;
+    if (needed <= length) return STACK_OK;
+
+    size_t size = mstack->base.size;
+    if (!mstack_file_bytes(needed, size)){
+        STACK_STATS_PUSH_FAILED(mstack);
+        return STACK_ERR_FULL;
+    }
+
+    size_t new_length = length ? length : 1;
+    while (new_length < needed){
+        size_t next = new_length * 2;
+        new_length = next > new_length && mstack_file_bytes(next, size) ? next : needed;
+    }
+
+    size_t bytes = mstack_file_bytes(new_length, size);
+
+    //un fichier plus grand que la projection reste valide : length n'est mis a jour qu'apres le mremap
+    if (bytes > mstack->mapped){
+        void *map = ftruncate(mstack->fd, (off_t)bytes) ? MAP_FAILED : mremap(mstack->header, mstack->mapped, bytes, MREMAP_MAYMOVE);
+        if (map == MAP_FAILED){
+            STACK_STATS_PUSH_FAILED(mstack);
+            return STACK_ERR_NO_MEMORY;
+        }
+
+        STACK_STATS_ALLOC(mstack, bytes - mstack->mapped);
+        mstack->header = map;
+        mstack->data = (char*)map + MSTACK_DATA_OFFSET;
+        mstack->mapped = bytes;
+    }
+
+    mstack->header->length = new_length;
+
+    return STACK_OK;
+}
+
+static stack_error_t mstack_push(stack_t* stack, void* val){
+    assert(stack && val);
+
+    mstack_t *mstack = (mstack_t*)stack;
+    size_t top = mstack->header->top;
+
+    if (top == mstack->header->length){
+        stack_error_t err = mstack_reserve(mstack, top + 1);
+        if (err) return err;
+    }
+
+    memcpy(((char*)mstack->data)+(top * stack->size), val, stack->size);
+    mstack->header->top = top + 1;
+    STACK_STATS_PUSH(stack, 1);
+
+    return STACK_OK;
+}
+
+static void* mstack_peek(stack_t* stack){
+    assert(stack);
+
+    mstack_t *mstack = (mstack_t*)stack;
+
+    if(mstack_is_empty(stack))
+        return NULL;
+
+    return ((char*)mstack->data)+(mstack->header->top - 1) * stack->size;
+}
+
+static stack_error_t mstack_pop(stack_t* stack, void* popped){
+    assert(stack);
+
+    void *res = mstack_peek(stack);
+    if (!res) return STACK_ERR_EMPTY;
+
+    mstack_t *mstack = (mstack_t*)stack;
+    mstack->header->top--;
+    STACK_STATS_POP(stack, 1);
+
+    if(popped)
+        memcpy(popped, res, stack->size);
+
+    return STACK_OK;
+}
+
+static bool mstack_is_empty(stack_t* stack){
+    assert(stack);
+    return ((mstack_t*)stack)->header->top == 0;
+}
+
+static stack_error_t mstack_push_n(stack_t* stack, const void* vals, size_t n){
+    assert(stack && vals);
+
+    mstack_t *mstack = (mstack_t*)stack;
+    size_t top = mstack->header->top;
+
+    if (n > SIZE_MAX - top){
+        STACK_STATS_PUSH_FAILED(stack);
+        return STACK_ERR_FULL;
+    }
+
+    stack_error_t err = mstack_reserve(mstack, top + n);
+    if (err) return err;
+
+    memcpy(((char*)mstack->data)+(top * stack->size), vals, n * stack->size);
+    mstack->header->top = top + n;
+    STACK_STATS_PUSH(stack, n);
+
+    return STACK_OK;
+}
+
+static size_t mstack_pop_n(stack_t* stack, void* out, size_t n, stack_order_t order){
+    assert(stack);
+
+    mstack_t *mstack = (mstack_t*)stack;
+    size_t top = mstack->header->top;
+    size_t k = n < top ? n : top;
+
+    top -= k;
+    mstack->header->top = top;
+    STACK_STATS_POP(stack, k);
+    if(!out || k == 0) return k;
+
+    char *src = ((char*)mstack->data)+(top * stack->size);
+
+    if(order == STACK_ORDER_BOTTOM_UP){
+        memcpy(out, src, k * stack->size);
+        return k;
+    }
+
+    for(size_t i = 0; i < k; i++)
+        memcpy((char*)out + i * stack->size, src + (k - 1 - i) * stack->size, stack->size);
+
+    return k;
+}
+
+static void* mstack_emplace(stack_t* stack, stack_error_t* err){
+    assert(stack && err);
+
+    mstack_t *mstack = (mstack_t*)stack;
+    size_t top = mstack->header->top;
+
+    if (top == mstack->header->length && (*err = mstack_reserve(mstack, top + 1)))
+        return NULL;
+
+    mstack->header->top = top + 1;
+    STACK_STATS_PUSH(stack, 1);
+    return ((char*)mstack->data)+(top * stack->size);
+}
+
+//L'element reste en place dans le fichier jusqu'au prochain push
+static void* mstack_pop_view(stack_t* stack){
+    assert(stack);
+
+    void *res = mstack_peek(stack);
+    if(res){
+        ((mstack_t*)stack)->header->top--;
+        STACK_STATS_POP(stack, 1);
+    }
+
+    return res;
+}
+
+static size_t mstack_count(stack_t* stack){
+    assert(stack);
+    return ((mstack_t*)stack)->header->top;
+}
+
+//Seul top recule, en O(1) (la taille du fichier ne change pas)
+static void mstack_truncate(stack_t* stack, size_t count){
+    assert(stack && count <= ((mstack_t*)stack)->header->top);
+
+    STACK_STATS_POP(stack, ((mstack_t*)stack)->header->top - count);
+    ((mstack_t*)stack)->header->top = count;
+}
+
+static void* mstack_at(stack_t* stack, size_t depth){
+    assert(stack);
+
+    mstack_t *mstack = (mstack_t*)stack;
+    if (depth >= mstack->header->top) return NULL;
+
+    return ((char*)mstack->data) + (mstack->header->top - 1 - depth) * stack->size;
+}
+
+static stack_error_t mstack_foreach(stack_t* stack, stack_order_t order, stack_visitor_t visit, void* ctx){
+    assert(stack && visit);
+
+    mstack_t *mstack = (mstack_t*)stack;
+    size_t count = mstack->header->top;
+
+    for (size_t i = 0; i < count; i++){
+        size_t index = order == STACK_ORDER_BOTTOM_UP ? i : count - 1 - i;
+        if (!visit(((char*)mstack->data) + index * stack->size, ctx)) break;
+    }
+
+    return STACK_OK;
+}
+
+static void* mstack_find(stack_t* stack, const void* val){
+    assert(stack && val);
+
+    mstack_t *mstack = (mstack_t*)stack;
+    size_t index = stack_search_last(mstack->data, mstack->header->top, stack->size, val);
+
+    return index == STACK_SEARCH_NOT_FOUND ? NULL : ((char*)mstack->data) + index * stack->size;
+}
+
+//Les elements sont contigus dans la projection : un seul fwrite
+static stack_error_t mstack_save(stack_t* stack, FILE* file){
+    assert(stack && file);
+
+    mstack_t *mstack = (mstack_t*)stack;
+    size_t top = mstack->header->top;
+
+    if (fwrite(mstack->data, stack->size, top, file) != top)
+        return STACK_ERR_IO;
+
+    return STACK_OK;
+}
+
+//Agrandit le fichier pour tous les elements puis les lit directement dans la projection
+static stack_error_t mstack_load(stack_t* stack, FILE* file, size_t count){
+    assert(stack && file);
+
+    mstack_t *mstack = (mstack_t*)stack;
+    size_t top = mstack->header->top;
+
+    if (count > SIZE_MAX - top){
+        STACK_STATS_PUSH_FAILED(stack);
+        return STACK_ERR_FULL;
+    }
+
+    stack_error_t err = mstack_reserve(mstack, top + count);
+    if (err) return err;
+
+    if (fread(((char*)mstack->data)+(top * stack->size), stack->size, count, file) != count)
+        return STACK_ERR_IO;
+
+    mstack->header->top = top + count;
+    STACK_STATS_PUSH(stack, count);
+
+    return STACK_OK;
+}
@@ -0,0 +1,44 @@
+#ifndef __MSTACK_H__
+#define __MSTACK_H__
+
+#include <stdint.h>
+
+#include "stack.h"
+
+// L'en-tete au debut du fichier, les elements suivent a MSTACK_DATA_OFFSET (meme disposition que fstack_t::data)
+///@param magic: MSTACK_MAGIC, identifie un fichier de pile
+///@param version: La version du format (MSTACK_VERSION)
+///@param size: La taille d'un element
+///@param top: Le nombre d'elements dans la pile
+///@param length: La capacite du fichier en elements
+typedef struct _mstack_header_t{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t size;
+    uint64_t top;
+    uint64_t length;
+} mstack_header_t;
+
+#define MSTACK_MAGIC 0x4b4154534d4d5453ull // "STMMSTAK"
+#define MSTACK_VERSION 1
+#define MSTACK_DATA_OFFSET 64
+
+_Static_assert(sizeof(mstack_header_t) <= MSTACK_DATA_OFFSET, "mstack_header_t does not fit before the data");
+
+// top et length sont lus et ecrits directement dans l'en-tete projete : ils sont persistes avec les elements
+///@param fd: Le descripteur du fichier
+///@param header: Le debut de la projection (l'en-tete du fichier)
+///@param data: Le premier element (header + MSTACK_DATA_OFFSET)
+///@param mapped: La taille de la projection en octets
+typedef struct _mstack_t{
+    stack_t base;
+    int fd;
+    mstack_header_t *header;
+    void *data;
+    size_t mapped;
+} mstack_t;
+
+int mstack_init(mstack_t* stack, mstack_config_t config);
+
+#endif // __MSTACK_H__
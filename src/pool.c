@@ -0,0 +1,91 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "stack.h"
+#include "alloc.h"
+#include "pool.h"
+
+#define POOL_DEFAULT_BLOCKS_PER_SLAB 64
+
+// Arrondi au multiple de l'alignement maximal pour que chaque bloc soit correctement aligne
+#define POOL_ALIGN(n) (((n) + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1))
+
+stack_pool_t* stack_pool_create(size_t block_size, size_t blocks_per_slab, const stack_allocator_t* allocator){
+    stack_pool_t *pool = stack_mem_alloc(allocator, sizeof(*pool));
+    if (!pool) return (perror("malloc failed"), NULL);
+
+    pool->block_size = block_size ? POOL_ALIGN(block_size) : 0;
+    pool->blocks_per_slab = blocks_per_slab ? blocks_per_slab : POOL_DEFAULT_BLOCKS_PER_SLAB;
+    pool->free_list = NULL;
+    pool->slabs = NULL;
+    pool->allocator = allocator;
+
+    return pool;
+}
+
+void stack_pool_destroy(stack_pool_t** pool_ptr){
+    if (!pool_ptr || !*pool_ptr){
+        fprintf(stderr, "[!] stack_pool_destroy : unable to destroy pool, pool is NULL or invalid\n");
+        return;
+    }
+
+    stack_pool_t *pool = *pool_ptr;
+
+    while(pool->slabs){
+        pool_slab_t *tmp = pool->slabs;
+        pool->slabs = tmp->next;
+        stack_mem_free(pool->allocator, tmp);
+    }
+
+    stack_mem_free(pool->allocator, pool);
+    *pool_ptr = NULL;
+}
+
+//Alloue une nouvelle tranche et chaine tous ses blocs dans la liste libre
+static int pool_grow(stack_pool_t* pool){
+    size_t header = POOL_ALIGN(sizeof(pool_slab_t));
+    if (pool->blocks_per_slab > (SIZE_MAX - header) / pool->block_size) return -1;
+
+    pool_slab_t *slab = stack_mem_alloc(pool->allocator, header + pool->blocks_per_slab * pool->block_size);
+    if (!slab) return -1;
+
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+
+    char *blocks = (char*)slab + header;
+    for (size_t i = pool->blocks_per_slab; i-- > 0;){
+        pool_block_t *b = (pool_block_t*)(blocks + i * pool->block_size);
+        b->next = pool->free_list;
+        pool->free_list = b;
+    }
+
+    return 0;
+}
+
+void* pool_alloc(stack_pool_t* pool, size_t bytes){
+    assert(pool);
+
+    if (pool->block_size == 0)
+        pool->block_size = POOL_ALIGN(bytes < sizeof(pool_block_t) ? sizeof(pool_block_t) : bytes);
+
+    if (bytes > pool->block_size) return NULL;
+
+    if (!pool->free_list && pool_grow(pool)) return NULL;
+
+    pool_block_t *b = pool->free_list;
+    pool->free_list = b->next;
+    return b;
+}
+
+void pool_free(stack_pool_t* pool, void* block){
+    assert(pool);
+    if (!block) return;
+
+    pool_block_t *b = block;
+    b->next = pool->free_list;
+    pool->free_list = b;
+}
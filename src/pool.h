@@ -0,0 +1,34 @@
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include "stack.h"
+
+// Une tranche de blocs allouee d'un coup, les tranches sont chainees pour etre liberees a la destruction
+typedef struct _pool_slab_t{
+    struct _pool_slab_t *next;
+} pool_slab_t;
+
+// Un bloc libre, chaine dans la liste libre du pool
+typedef struct _pool_block_t{
+    struct _pool_block_t *next;
+} pool_block_t;
+
+///@param block_size: La taille d'un bloc (0 tant qu'aucune allocation n'a ete faite)
+///@param blocks_per_slab: Le nombre de blocs par tranche
+///@param free_list: Les blocs disponibles
+///@param slabs: Toutes les tranches allouees
+struct _stack_pool_t{
+    size_t block_size;
+    size_t blocks_per_slab;
+    pool_block_t *free_list;
+    pool_slab_t *slabs;
+    const stack_allocator_t *allocator;
+};
+
+///@brief Retourne un bloc d'au moins bytes octets (NULL si bytes > block_size ou si l'allocation echoue, sans message)
+void* pool_alloc(stack_pool_t* pool, size_t bytes);
+
+///@brief Rend un bloc au pool
+void pool_free(stack_pool_t* pool, void* block);
+
+#endif // __POOL_H__
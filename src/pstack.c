@@ -0,0 +1,293 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "stack.h"
+#include "pstack.h"
+#include "alloc.h"
+#include "pool.h"
+#include "stats.h"
+
+// Taille de l'entete d'un noeud, arrondie pour que l'element soit correctement aligne
+#define PNODE_HEADER_SIZE ((sizeof(pnode_t) + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1))
+
+#define PNODE_DATA(node) ((char*)(node) + PNODE_HEADER_SIZE)
+
+static void pstack_destroy(stack_t** stack_ptr);
+static stack_error_t pstack_push(stack_t* stack, void* val);
+static void* pstack_peek(stack_t* stack);
+static stack_error_t pstack_pop(stack_t* stack, void* popped);
+static bool pstack_is_empty(stack_t* stack);
+static void* pstack_emplace(stack_t* stack, stack_error_t* err);
+static stack_t* pstack_fork(stack_t* stack);
+static size_t pstack_count(stack_t* stack);
+static void pstack_truncate(stack_t* stack, size_t count);
+static void* pstack_at(stack_t* stack, size_t depth);
+static stack_error_t pstack_foreach(stack_t* stack, stack_order_t order, stack_visitor_t visit, void* ctx);
+static stack_error_t pstack_save(stack_t* stack, FILE* file);
+
+int pstack_init(pstack_t* stack, pstack_config_t config){
+    if (!stack) return (fprintf(stderr, "[!] pstack_init : invalid stack pointer\n"), -1);
+    if (config.size == 0) return (fprintf(stderr, "[!] pstack_init : invalid config size : size must be > 0\n"), -1);
+    if (config.size > SIZE_MAX - PNODE_HEADER_SIZE) return (fprintf(stderr, "[!] pstack_init : invalid config size : size is too large\n"), -1);
+    if (config.pool && config.pool->block_size && config.pool->block_size < PNODE_HEADER_SIZE + config.size)
+        return (fprintf(stderr, "[!] pstack_init : invalid config pool : pool blocks are too small for a node\n"), -1);
+
+    memset(stack, 0, sizeof(*stack));
+
+    stack->base = (stack_t){
+        .type = STACK_TYPE_PERSISTENT,
+        .size = config.size,
+        .allocator = config.allocator,
+        .destroy = pstack_destroy,
+        .push = pstack_push,
+        .peek = pstack_peek,
+        .pop = pstack_pop,
+        .is_empty = pstack_is_empty,
+        .emplace = pstack_emplace,
+        .fork = pstack_fork,
+        .count = pstack_count,
+        .truncate = pstack_truncate,
+        .at = pstack_at,
+        .foreach = pstack_foreach,
+        .save = pstack_save
+    };
+
+    stack->top = NULL;
+    stack->count = 0;
+    stack->pool = config.pool;
+
+    return 0;
+}
+
+static pnode_t* pstack_alloc_node(pstack_t* pstack){
+    size_t bytes = PNODE_HEADER_SIZE + pstack->base.size;
+    pnode_t *node = pstack->pool ? pool_alloc(pstack->pool, bytes) : stack_mem_alloc(pstack->base.allocator, bytes);
+    if (!node) return NULL;
+
+    STACK_STATS_ALLOC(pstack, bytes);
+    return node;
+}
+
+static void pstack_free_node(pstack_t* pstack, pnode_t* node){
+    STACK_STATS_FREE(pstack, PNODE_HEADER_SIZE + pstack->base.size);
+
+    if (pstack->pool) pool_free(pstack->pool, node);
+    else stack_mem_free(pstack->base.allocator, node);
+}
+
+//Rend une reference sur node : les noeuds qui ne sont plus references par personne sont liberes,
+//en descendant jusqu'au premier noeud encore partage
+//Un noeud avec une seule reference n'appartient qu'a l'appelant : pas besoin d'operation atomique
+static void pstack_release(pstack_t* pstack, pnode_t* node){
+    while (node){
+        if (atomic_load_explicit(&node->refs, memory_order_acquire) != 1
+            && atomic_fetch_sub_explicit(&node->refs, 1, memory_order_acq_rel) != 1)
+            return;
+
+        pnode_t *next = node->next;
+        pstack_free_node(pstack, node);
+        node = next;
+    }
+}
+
+static void pstack_destroy(stack_t** stack_ptr){
+    assert(stack_ptr && *stack_ptr);
+    pstack_t *stack = (pstack_t*)*stack_ptr;
+
+    pstack_release(stack, stack->top);
+
+    stack_mem_free(stack->base.allocator, stack);
+    *stack_ptr = NULL;
+}
+
+//Ajoute un noeud au sommet : il recoit la reference que la version avait sur l'ancien sommet
+static void* pstack_emplace(stack_t* stack, stack_error_t* err){
+    assert(stack && err);
+
+    pstack_t *pstack = (pstack_t*)stack;
+
+    pnode_t *node = pstack_alloc_node(pstack);
+    if (!node){
+        STACK_STATS_PUSH_FAILED(stack);
+        *err = STACK_ERR_NO_MEMORY;
+        return NULL;
+    }
+
+    atomic_init(&node->refs, 1);
+    node->next = pstack->top;
+
+    pstack->top = node;
+    pstack->count++;
+    STACK_STATS_PUSH(stack, 1);
+
+    return PNODE_DATA(node);
+}
+
+static stack_error_t pstack_push(stack_t* stack, void* val){
+    assert(stack && val);
+
+    stack_error_t err = STACK_OK;
+    void *dest = pstack_emplace(stack, &err);
+    if (!dest) return err;
+
+    memcpy(dest, val, stack->size);
+
+    return STACK_OK;
+}
+
+static void* pstack_peek(stack_t* stack){
+    assert(stack);
+
+    pstack_t *pstack = (pstack_t*)stack;
+    return pstack->top ? PNODE_DATA(pstack->top) : NULL;
+}
+
+static stack_error_t pstack_pop(stack_t* stack, void* popped){
+    assert(stack);
+
+    pstack_t *pstack = (pstack_t*)stack;
+    pnode_t *node = pstack->top;
+
+    if (!node) return STACK_ERR_EMPTY;
+
+    if (popped)
+        memcpy(popped, PNODE_DATA(node), stack->size);
+
+    pnode_t *next = node->next;
+
+    if (atomic_load_explicit(&node->refs, memory_order_acquire) == 1){
+        //le noeud n'appartient qu'a cette version : sa reference sur next revient a la version
+        pstack_free_node(pstack, node);
+    }else{
+        if (next) atomic_fetch_add_explicit(&next->refs, 1, memory_order_relaxed);
+        pstack_release(pstack, node);
+    }
+
+    pstack->top = next;
+    pstack->count--;
+    STACK_STATS_POP(stack, 1);
+
+    return STACK_OK;
+}
+
+static bool pstack_is_empty(stack_t* stack){
+    assert(stack);
+    return ((pstack_t*)stack)->top == NULL;
+}
+
+//La nouvelle version partage le sommet : une seule reference de plus, quel que soit le nombre d'elements
+static stack_t* pstack_fork(stack_t* stack){
+    assert(stack);
+
+    pstack_t *pstack = (pstack_t*)stack;
+
+    pstack_t *fork = stack_mem_alloc(stack->allocator, sizeof(*fork));
+    if (!fork) return NULL;
+
+    *fork = *pstack;
+#ifdef STACK_STATS
+    memset(&fork->base.stats, 0, sizeof(fork->base.stats));
+    STACK_STATS_SET_DEPTH(fork, pstack->count);
+    STACK_STATS_ALLOC(fork, sizeof(*fork));
+#endif
+
+    if (fork->top) atomic_fetch_add_explicit(&fork->top->refs, 1, memory_order_relaxed);
+
+    return (stack_t*)fork;
+}
+
+static size_t pstack_count(stack_t* stack){
+    assert(stack);
+    return ((pstack_t*)stack)->count;
+}
+
+//La version prend une reference sur son nouveau sommet puis rend celle de l'ancien :
+//seuls les noeuds qui n'appartenaient qu'a elle sont liberes
+static void pstack_truncate(stack_t* stack, size_t count){
+    assert(stack);
+
+    pstack_t *pstack = (pstack_t*)stack;
+    assert(count <= pstack->count);
+
+    if (count == pstack->count) return;
+
+    pnode_t *top = pstack->top;
+    for (size_t i = count; i < pstack->count; i++)
+        top = top->next;
+
+    if (top) atomic_fetch_add_explicit(&top->refs, 1, memory_order_relaxed);
+    pstack_release(pstack, pstack->top);
+
+    STACK_STATS_POP(stack, pstack->count - count);
+    pstack->top = top;
+    pstack->count = count;
+}
+
+static void* pstack_at(stack_t* stack, size_t depth){
+    assert(stack);
+
+    pstack_t *pstack = (pstack_t*)stack;
+    if (depth >= pstack->count) return NULL;
+
+    pnode_t *node = pstack->top;
+    while (depth--) node = node->next;
+
+    return PNODE_DATA(node);
+}
+
+//Les noeuds sont chaines du sommet vers le fond et peuvent etre partages (on ne peut pas inverser la liste) :
+//du fond vers le sommet, on note leurs adresses dans un tableau temporaire
+static stack_error_t pstack_foreach(stack_t* stack, stack_order_t order, stack_visitor_t visit, void* ctx){
+    assert(stack && visit);
+
+    pstack_t *pstack = (pstack_t*)stack;
+
+    if (order == STACK_ORDER_TOP_DOWN){
+        for (pnode_t *node = pstack->top; node; node = node->next)
+            if (!visit(PNODE_DATA(node), ctx)) break;
+        return STACK_OK;
+    }
+
+    if (pstack->count == 0) return STACK_OK;
+    if (pstack->count > SIZE_MAX / sizeof(pnode_t*)) return STACK_ERR_NO_MEMORY;
+
+    pnode_t **nodes = stack_mem_alloc(stack->allocator, pstack->count * sizeof(pnode_t*));
+    if (!nodes) return STACK_ERR_NO_MEMORY;
+
+    size_t i = pstack->count;
+    for (pnode_t *node = pstack->top; node; node = node->next)
+        nodes[--i] = node;
+
+    for (i = 0; i < pstack->count; i++)
+        if (!visit(PNODE_DATA(nodes[i]), ctx)) break;
+
+    stack_mem_free(stack->allocator, nodes);
+    return STACK_OK;
+}
+
+typedef struct {
+    FILE *file;
+    size_t size;
+    bool failed;
+} pstack_save_ctx_t;
+
+static bool pstack_save_visit(void* elem, void* ctx){
+    pstack_save_ctx_t *save = ctx;
+    save->failed = fwrite(elem, save->size, 1, save->file) != 1;
+    return !save->failed;
+}
+
+static stack_error_t pstack_save(stack_t* stack, FILE* file){
+    assert(stack && file);
+
+    pstack_save_ctx_t save = {.file = file, .size = stack->size, .failed = false};
+
+    stack_error_t err = pstack_foreach(stack, STACK_ORDER_BOTTOM_UP, pstack_save_visit, &save);
+    if (err) return err;
+
+    return save.failed ? STACK_ERR_IO : STACK_OK;
+}
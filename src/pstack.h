@@ -0,0 +1,29 @@
+#ifndef __PSTACK_H__
+#define __PSTACK_H__
+
+#include <stdatomic.h>
+
+#include "stack.h"
+
+// Un noeud de la pile, partage par toutes les versions qui le contiennent : l'element est dans
+// la meme allocation, apres l'entete. Un noeud n'est jamais modifie une fois ajoute.
+///@param refs: Le nombre de references (versions dont c'est le sommet et noeuds dont c'est le suivant)
+///@param next: Le noeud en dessous (NULL au fond de la pile)
+typedef struct _pnode_t{
+    _Atomic size_t refs;
+    struct _pnode_t *next;
+} pnode_t;
+
+///@param top: Le noeud au sommet de la version (NULL si la pile est vide), la version en detient une reference
+///@param count: Le nombre d'elements de la version
+///@param pool: Le pool d'ou viennent les noeuds (NULL = base.allocator)
+typedef struct _pstack_t{
+    stack_t base;
+    pnode_t *top;
+    size_t count;
+    stack_pool_t *pool;
+} pstack_t;
+
+int pstack_init(pstack_t* stack, pstack_config_t config);
+
+#endif // __PSTACK_H__
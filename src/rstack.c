@@ -0,0 +1,372 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "stack.h"
+#include "rstack.h"
+#include "alloc.h"
+#include "stats.h"
+#include "search.h"
+
+static void rstack_destroy(stack_t** stack_ptr);
+static stack_error_t rstack_push(stack_t* stack, void* val);
+static void* rstack_peek(stack_t* stack);
+static stack_error_t rstack_pop(stack_t* stack, void* popped);
+static bool rstack_is_empty(stack_t* stack);
+static stack_error_t rstack_push_n(stack_t* stack, const void* vals, size_t n);
+static size_t rstack_pop_n(stack_t* stack, void* out, size_t n, stack_order_t order);
+static void* rstack_emplace(stack_t* stack, stack_error_t* err);
+static void* rstack_pop_view(stack_t* stack);
+static size_t rstack_count(stack_t* stack);
+static void rstack_truncate(stack_t* stack, size_t count);
+static void* rstack_at(stack_t* stack, size_t depth);
+static stack_error_t rstack_foreach(stack_t* stack, stack_order_t order, stack_visitor_t visit, void* ctx);
+static void* rstack_find(stack_t* stack, const void* val);
+static stack_error_t rstack_save(stack_t* stack, FILE* file);
+static stack_error_t rstack_load(stack_t* stack, FILE* file, size_t count);
+static size_t rstack_shrink(stack_t* stack);
+
+//Arrondit bytes au multiple de unit superieur (unit est une puissance de 2), 0 si le resultat depasse SIZE_MAX
+static size_t rstack_round_up(size_t bytes, size_t unit){
+    if (bytes > SIZE_MAX - (unit - 1)) return 0;
+    return (bytes + unit - 1) & ~(unit - 1);
+}
+
+int rstack_init(rstack_t* stack, rstack_config_t config){
+    if (!stack) return (fprintf(stderr, "[!] rstack_init : invalid stack pointer\n"), -1);
+    if (config.size == 0) return (fprintf(stderr, "[!] rstack_init : invalid config size : size must be > 0\n"), -1);
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t max_length = config.max_length ? config.max_length : RSTACK_DEFAULT_RESERVE_BYTES / config.size;
+    if (max_length == 0) max_length = 1;
+    if (max_length > SIZE_MAX / config.size) return (fprintf(stderr, "[!] rstack_init : invalid config max_length : range is too large\n"), -1);
+
+    size_t reserved = rstack_round_up(max_length * config.size, page);
+    size_t commit_bytes = rstack_round_up(config.commit_bytes ? config.commit_bytes : RSTACK_DEFAULT_COMMIT_BYTES, page);
+    size_t decommit_bytes = rstack_round_up(config.decommit_bytes ? config.decommit_bytes : RSTACK_DEFAULT_DECOMMIT_BYTES, page);
+    if (!reserved || !commit_bytes || !decommit_bytes)
+        return (fprintf(stderr, "[!] rstack_init : invalid config : sizes are too large\n"), -1);
+
+    memset(stack, 0, sizeof(*stack));
+
+    stack->base = (stack_t){
+        .type = STACK_TYPE_RESERVED,
+        .size = config.size,
+        .allocator = config.allocator,
+        .destroy = rstack_destroy,
+        .push = rstack_push,
+        .peek = rstack_peek,
+        .pop = rstack_pop,
+        .is_empty = rstack_is_empty,
+        .push_n = rstack_push_n,
+        .pop_n = rstack_pop_n,
+        .emplace = rstack_emplace,
+        .pop_view = rstack_pop_view,
+        .count = rstack_count,
+        .truncate = rstack_truncate,
+        .at = rstack_at,
+        .foreach = rstack_foreach,
+        .find = rstack_find,
+        .save = rstack_save,
+        .load = rstack_load,
+        .shrink = rstack_shrink
+    };
+
+    //MAP_NORESERVE : la plage ne compte pas dans la memoire engagee tant que ses pages ne sont pas accessibles
+    void *data = mmap(NULL, reserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (data == MAP_FAILED) return (perror("mmap failed"), -1);
+
+    stack->data = data;
+    stack->top = 0;
+    stack->length = 0;
+    stack->max_length = max_length;
+    stack->reserved = reserved;
+    stack->committed = 0;
+    stack->commit_bytes = commit_bytes;
+    stack->decommit_bytes = decommit_bytes;
+    stack->shrink_length = 0;
+
+    return 0;
+}
+
+static void rstack_destroy(stack_t** stack){
+    assert(stack && *stack);
+
+    rstack_t *rstack = (rstack_t*)*stack;
+    munmap(rstack->data, rstack->reserved);
+
+    stack_mem_free((*stack)->allocator, *stack);
+    *stack = NULL;
+}
+
+//Met a jour length et le seuil de decommit apres un changement de committed
+//Le seuil laisse deux marges de decommit_bytes (plus un element) au-dessus du sommet : apres un decommit,
+//il reste une marge avant le prochain commit, une pile qui oscille autour d'une frontiere ne fait pas d'appel systeme
+static void rstack_set_committed(rstack_t* rstack, size_t committed){
+    rstack->committed = committed;
+    rstack->length = committed / rstack->base.size;
+    if (rstack->length > rstack->max_length) rstack->length = rstack->max_length;
+
+    size_t slack = 2 * rstack->decommit_bytes + rstack->base.size;
+    rstack->shrink_length = committed > slack ? (committed - slack) / rstack->base.size : 0;
+}
+
+//Rend accessibles les pages necessaires pour needed elements, par pas de commit_bytes
+//Un echec compte comme un ajout refuse : rstack_commit n'est appele que pour ajouter des elements
+static stack_error_t rstack_commit(rstack_t* rstack, size_t needed){
+    if (needed <= rstack->length) return STACK_OK;
+
+    if (needed > rstack->max_length){
+        STACK_STATS_PUSH_FAILED(rstack);
+        return STACK_ERR_FULL;
+    }
+
+    size_t committed = rstack_round_up(needed * rstack->base.size, rstack->commit_bytes);
+    if (committed == 0 || committed > rstack->reserved) committed = rstack->reserved;
+
+    if (mprotect((char*)rstack->data + rstack->committed, committed - rstack->committed, PROT_READ | PROT_WRITE)){
+        STACK_STATS_PUSH_FAILED(rstack);
+        return STACK_ERR_NO_MEMORY;
+    }
+
+    STACK_STATS_ALLOC(rstack, committed - rstack->committed);
+    rstack_set_committed(rstack, committed);
+
+    return STACK_OK;
+}
+
+//Libere les pages au-dela du sommet plus une marge de margin octets : madvise rend la memoire au systeme,
+//mprotect rend les pages inaccessibles (un acces au-dela du sommet fait une erreur au lieu de relire des zeros)
+//L'element juste au-dessus du sommet reste accessible (pointeur retourne par pop_view)
+//Retourne le nombre d'octets rendus
+static size_t rstack_decommit(rstack_t* rstack, size_t margin){
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t keep = rstack_round_up((rstack->top + 1) * rstack->base.size + margin, page);
+    if (keep == 0 || keep >= rstack->committed) return 0;
+
+    char *start = (char*)rstack->data + keep;
+    size_t bytes = rstack->committed - keep;
+    if (madvise(start, bytes, MADV_DONTNEED) || mprotect(start, bytes, PROT_NONE)) return 0;
+
+    STACK_STATS_FREE(rstack, bytes);
+    STACK_STATS_TRIM(rstack, bytes);
+    rstack_set_committed(rstack, keep);
+
+    return bytes;
+}
+
+static stack_error_t rstack_push(stack_t* stack, void* val){
+    assert(stack && val);
+
+    rstack_t *rstack = (rstack_t*)stack;
+
+    if (rstack->top == rstack->length){
+        stack_error_t err = rstack_commit(rstack, rstack->top + 1);
+        if (err) return err;
+    }
+
+    memcpy(((char*)rstack->data)+(rstack->top * stack->size), val, stack->size);
+
+    rstack->top++;
+    STACK_STATS_PUSH(stack, 1);
+
+    return STACK_OK;
+}
+
+static void* rstack_peek(stack_t* stack){
+    assert(stack);
+
+    rstack_t *rstack = (rstack_t*)stack;
+
+    if(rstack_is_empty(stack))
+        return NULL;
+
+    return ((char*)rstack->data)+(rstack->top - 1) * stack->size;
+}
+
+static stack_error_t rstack_pop(stack_t* stack, void* popped){
+    assert(stack);
+
+    void *res = rstack_peek(stack);
+    if (!res) return STACK_ERR_EMPTY;
+
+    rstack_t *rstack = (rstack_t*)stack;
+    rstack->top--;
+    STACK_STATS_POP(stack, 1);
+
+    if(popped)
+        memcpy(popped, res, stack->size);
+
+    if (rstack->top < rstack->shrink_length) rstack_decommit(rstack, rstack->decommit_bytes);
+
+    return STACK_OK;
+}
+
+static bool rstack_is_empty(stack_t* stack){
+    assert(stack);
+    return ((rstack_t*)stack)->top == 0;
+}
+
+static stack_error_t rstack_push_n(stack_t* stack, const void* vals, size_t n){
+    assert(stack && vals);
+
+    rstack_t *rstack = (rstack_t*)stack;
+
+    if (n > rstack->max_length - rstack->top){
+        STACK_STATS_PUSH_FAILED(stack);
+        return STACK_ERR_FULL;
+    }
+
+    stack_error_t err = rstack_commit(rstack, rstack->top + n);
+    if (err) return err;
+
+    memcpy(((char*)rstack->data)+(rstack->top * stack->size), vals, n * stack->size);
+    rstack->top += n;
+    STACK_STATS_PUSH(stack, n);
+
+    return STACK_OK;
+}
+
+static size_t rstack_pop_n(stack_t* stack, void* out, size_t n, stack_order_t order){
+    assert(stack);
+
+    rstack_t *rstack = (rstack_t*)stack;
+    size_t k = n < rstack->top ? n : rstack->top;
+
+    rstack->top -= k;
+    STACK_STATS_POP(stack, k);
+
+    char *src = ((char*)rstack->data)+(rstack->top * stack->size);
+
+    if(out && order == STACK_ORDER_BOTTOM_UP){
+        memcpy(out, src, k * stack->size);
+    }else if(out){
+        for(size_t i = 0; i < k; i++)
+            memcpy((char*)out + i * stack->size, src + (k - 1 - i) * stack->size, stack->size);
+    }
+
+    if (rstack->top < rstack->shrink_length) rstack_decommit(rstack, rstack->decommit_bytes);
+
+    return k;
+}
+
+static void* rstack_emplace(stack_t* stack, stack_error_t* err){
+    assert(stack && err);
+
+    rstack_t *rstack = (rstack_t*)stack;
+
+    if (rstack->top == rstack->length && (*err = rstack_commit(rstack, rstack->top + 1)))
+        return NULL;
+
+    STACK_STATS_PUSH(stack, 1);
+    return ((char*)rstack->data)+(rstack->top++ * stack->size);
+}
+
+//L'element reste en place jusqu'au prochain push : le decommit garde toujours l'element au-dessus du sommet
+static void* rstack_pop_view(stack_t* stack){
+    assert(stack);
+
+    rstack_t *rstack = (rstack_t*)stack;
+
+    void *res = rstack_peek(stack);
+    if(res){
+        rstack->top--;
+        STACK_STATS_POP(stack, 1);
+        if (rstack->top < rstack->shrink_length) rstack_decommit(rstack, rstack->decommit_bytes);
+    }
+
+    return res;
+}
+
+static size_t rstack_count(stack_t* stack){
+    assert(stack);
+    return ((rstack_t*)stack)->top;
+}
+
+static void rstack_truncate(stack_t* stack, size_t count){
+    assert(stack && count <= ((rstack_t*)stack)->top);
+
+    rstack_t *rstack = (rstack_t*)stack;
+
+    STACK_STATS_POP(stack, rstack->top - count);
+    rstack->top = count;
+
+    if (rstack->top < rstack->shrink_length) rstack_decommit(rstack, rstack->decommit_bytes);
+}
+
+static void* rstack_at(stack_t* stack, size_t depth){
+    assert(stack);
+
+    rstack_t *rstack = (rstack_t*)stack;
+    if (depth >= rstack->top) return NULL;
+
+    return ((char*)rstack->data) + (rstack->top - 1 - depth) * stack->size;
+}
+
+static stack_error_t rstack_foreach(stack_t* stack, stack_order_t order, stack_visitor_t visit, void* ctx){
+    assert(stack && visit);
+
+    rstack_t *rstack = (rstack_t*)stack;
+    size_t count = rstack->top;
+
+    for (size_t i = 0; i < count; i++){
+        size_t index = order == STACK_ORDER_BOTTOM_UP ? i : count - 1 - i;
+        if (!visit(((char*)rstack->data) + index * stack->size, ctx)) break;
+    }
+
+    return STACK_OK;
+}
+
+static void* rstack_find(stack_t* stack, const void* val){
+    assert(stack && val);
+
+    rstack_t *rstack = (rstack_t*)stack;
+    size_t index = stack_search_last(rstack->data, rstack->top, stack->size, val);
+
+    return index == STACK_SEARCH_NOT_FOUND ? NULL : ((char*)rstack->data) + index * stack->size;
+}
+
+//Les elements sont contigus : un seul fwrite
+static stack_error_t rstack_save(stack_t* stack, FILE* file){
+    assert(stack && file);
+
+    rstack_t *rstack = (rstack_t*)stack;
+
+    if (fwrite(rstack->data, stack->size, rstack->top, file) != rstack->top)
+        return STACK_ERR_IO;
+
+    return STACK_OK;
+}
+
+//Rend accessibles les pages de tous les elements puis les lit directement a leur place
+static stack_error_t rstack_load(stack_t* stack, FILE* file, size_t count){
+    assert(stack && file);
+
+    rstack_t *rstack = (rstack_t*)stack;
+
+    if (count > rstack->max_length - rstack->top){
+        STACK_STATS_PUSH_FAILED(stack);
+        return STACK_ERR_FULL;
+    }
+
+    stack_error_t err = rstack_commit(rstack, rstack->top + count);
+    if (err) return err;
+
+    if (fread(((char*)rstack->data)+(rstack->top * stack->size), stack->size, count, file) != count)
+        return STACK_ERR_IO;
+
+    rstack->top += count;
+    STACK_STATS_PUSH(stack, count);
+
+    return STACK_OK;
+}
+
+static size_t rstack_shrink(stack_t* stack){
+    assert(stack);
+    return rstack_decommit((rstack_t*)stack, 0);
+}
@@ -0,0 +1,31 @@
+#ifndef __RSTACK_H__
+#define __RSTACK_H__
+
+#include "stack.h"
+
+// Les trois premiers champs ont la meme disposition que fstack_t (data + top * size)
+// data est le debut d'une plage d'adresses reservee une fois pour toutes : elle n'est jamais deplacee,
+// seules ses pages sont rendues accessibles (commit) ou liberees (decommit) au fil des push et des pop
+///@param length: Le nombre d'elements que contiennent les pages accessibles
+///@param max_length: Le nombre d'elements que contient la plage reservee
+///@param reserved: La taille de la plage reservee en octets
+///@param committed: Le nombre d'octets accessibles au debut de la plage (multiple de la taille d'une page)
+///@param commit_bytes: La granularite des commits (multiple de la taille d'une page)
+///@param decommit_bytes: La marge gardee accessible au-dessus du sommet apres un decommit
+///@param shrink_length: En dessous de ce nombre d'elements, un pop libere les pages au-dela de la marge
+typedef struct _rstack_t{
+    stack_t base;
+    void *data;
+    size_t top;
+    size_t length;
+    size_t max_length;
+    size_t reserved;
+    size_t committed;
+    size_t commit_bytes;
+    size_t decommit_bytes;
+    size_t shrink_length;
+} rstack_t;
+
+int rstack_init(rstack_t* stack, rstack_config_t config);
+
+#endif // __RSTACK_H__
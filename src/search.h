@@ -0,0 +1,75 @@
+#ifndef __SEARCH_H__
+#define __SEARCH_H__
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Recherche d'un element dans un tableau contigu (fstack, gstack, mstack et les blocs de dstack).
+// Les elements sont compares octet par octet, comme memcmp.
+//
+// Pour les elements de 4 et 8 octets, la comparaison se fait 16 octets a la fois avec SSE2 :
+// un cmpeq + movemask par groupe de 4 (ou 2) elements au lieu d'un memcmp par element.
+
+#define STACK_SEARCH_NOT_FOUND SIZE_MAX
+
+//Retourne l'index du dernier element egal a val parmi les count elements de data (le plus proche du sommet)
+static inline size_t stack_search_last_generic(const void* data, size_t count, size_t size, const void* val){
+    const char *bytes = data;
+    while (count--){
+        if (memcmp(bytes + count * size, val, size) == 0) return count;
+    }
+    return STACK_SEARCH_NOT_FOUND;
+}
+
+#ifdef __SSE2__
+
+static inline size_t stack_search_last_4(const void* data, size_t count, const void* val){
+    const char *bytes = data;
+    int32_t key;
+    memcpy(&key, val, sizeof(key));
+    __m128i needle = _mm_set1_epi32(key);
+
+    size_t i = count;
+    for (; i >= 4; i -= 4){
+        __m128i block = _mm_loadu_si128((const __m128i*)(bytes + (i - 4) * 4));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi32(block, needle));
+        //4 bits de masque par element : le bit le plus haut donne le dernier element egal
+        if (mask) return i - 4 + (31 - (size_t)__builtin_clz(mask)) / 4;
+    }
+
+    return stack_search_last_generic(data, i, 4, val);
+}
+
+static inline size_t stack_search_last_8(const void* data, size_t count, const void* val){
+    const char *bytes = data;
+    int64_t key;
+    memcpy(&key, val, sizeof(key));
+    __m128i needle = _mm_set1_epi64x(key);
+
+    size_t i = count;
+    for (; i >= 2; i -= 2){
+        __m128i block = _mm_loadu_si128((const __m128i*)(bytes + (i - 2) * 8));
+        //SSE2 n'a pas de cmpeq sur 64 bits : un element est egal si ses deux moities de 32 bits le sont
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi32(block, needle));
+        if ((mask & 0xFF00) == 0xFF00) return i - 1;
+        if ((mask & 0x00FF) == 0x00FF) return i - 2;
+    }
+
+    return stack_search_last_generic(data, i, 8, val);
+}
+
+#endif // __SSE2__
+
+static inline size_t stack_search_last(const void* data, size_t count, size_t size, const void* val){
+#ifdef __SSE2__
+    if (size == 4) return stack_search_last_4(data, count, val);
+    if (size == 8) return stack_search_last_8(data, count, val);
+#endif
+    return stack_search_last_generic(data, count, size, val);
+}
+
+#endif // __SEARCH_H__
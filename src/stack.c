@@ -1,47 +1,269 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 
 #include "stack.h"
 #include "fstack.h"
 #include "dstack.h"
+#include "gstack.h"
+#include "cstack.h"
+#include "wstack.h"
+#include "mstack.h"
+#include "pstack.h"
+#include "istack.h"
+#include "vstack.h"
+#include "rstack.h"
+#include "tstack.h"
+#include "alloc.h"
+#include "stats.h"
+
+// Les fonctions de tstack.h lisent le tableau des piles fixes et extensibles par tstack_layout_t
+_Static_assert(offsetof(fstack_t, data) == offsetof(tstack_layout_t, data) && offsetof(gstack_t, data) == offsetof(tstack_layout_t, data), "tstack_layout_t does not match fstack_t and gstack_t");
+_Static_assert(offsetof(fstack_t, top) == offsetof(tstack_layout_t, top) && offsetof(gstack_t, top) == offsetof(tstack_layout_t, top), "tstack_layout_t does not match fstack_t and gstack_t");
+_Static_assert(offsetof(fstack_t, length) == offsetof(tstack_layout_t, length) && offsetof(gstack_t, length) == offsetof(tstack_layout_t, length), "tstack_layout_t does not match fstack_t and gstack_t");
+_Static_assert(offsetof(fstack_t, high_water) == offsetof(tstack_layout_t, high_water) && offsetof(gstack_t, high_water) == offsetof(tstack_layout_t, high_water), "tstack_layout_t does not match fstack_t and gstack_t");
+
+// Taille du tampon de l'implementation generique de stack_load
+#define STACK_LOAD_BUFFER_BYTES (64u << 10)
+
+#define STACK_SNAPSHOT_MAGIC 0x4b415453u // "STAK"
+#define STACK_SNAPSHOT_VERSION 1
+
+// L'en-tete d'un snapshot ecrit par stack_save, suivi de count elements de size octets
+typedef struct _stack_snapshot_header_t{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t size;
+    uint64_t count;
+} stack_snapshot_header_t;
+
+// L'allocateur des piles creees par stack_init_in : la zone appartient a l'appelant, destroy ne libere rien
+static void* stack_in_place_alloc(void* ctx, size_t bytes){ (void)ctx; (void)bytes; return NULL; }
+static void* stack_in_place_realloc(void* ctx, void* ptr, size_t bytes){ (void)ctx; (void)ptr; (void)bytes; return NULL; }
+static void stack_in_place_free(void* ctx, void* ptr){ (void)ctx; (void)ptr; }
+
+static const stack_allocator_t stack_in_place_allocator = {
+    .alloc = stack_in_place_alloc,
+    .realloc = stack_in_place_realloc,
+    .free = stack_in_place_free
+};
+
+static stack_error_handler_t error_handler = NULL;
+static void *error_handler_ctx = NULL;
+
+//Signale une erreur au handler installe, sinon sur stderr si print est vrai
+static stack_error_t stack_report(stack_error_t err, const char* where, bool print){
+    if (err == STACK_OK) return err;
+
+    if (error_handler) error_handler(err, where, error_handler_ctx);
+    else if (print) fprintf(stderr, "[!] %s : %s\n", where, stack_strerror(err));
+
+    return err;
+}
 
 stack_t* stack_create(stack_type_t type, void* config){
     if (type == STACK_TYPE_FIXED){
-        fstack_t *stack = malloc(sizeof(*stack));
-        if (!stack) return (perror("malloc failed"), NULL);
-        
         fstack_config_t *fconfig = (fstack_config_t*)config;
         if (!fconfig){
             fprintf(stderr, "[!] stack_create : invalid config\n");
-            free(stack);
             return NULL;
         }
 
-        if(fstack_init(stack, *fconfig)){
-            free(stack);
+        size_t bytes = fstack_storage_bytes(*fconfig);
+        if (!bytes){
+            fprintf(stderr, "[!] stack_create : invalid config length : buffer is too large\n");
+            return NULL;
+        }
+
+        //en-tete et tableau dans une seule allocation, calloc donne directement des pages a zero
+        bool zeroed = !fconfig->no_zero;
+        fstack_t *stack = zeroed ? stack_mem_calloc(fconfig->allocator, 1, bytes) : stack_mem_alloc(fconfig->allocator, bytes);
+        if (!stack) return (perror("malloc failed"), NULL);
+
+        if(fstack_init(stack, *fconfig, zeroed)){
+            stack_mem_free(fconfig->allocator, stack);
             return NULL;
         }
         
+        STACK_STATS_ALLOC(stack, bytes);
         return (stack_t*)stack;
     }
     
     if (type == STACK_TYPE_DYNAMIC){
-        dstack_t *stack = malloc(sizeof(*stack));
-        if (!stack) return (perror("malloc failed"), NULL);
-        
         dstack_config_t *dconfig = (dstack_config_t*)config;
         if (!dconfig){
             fprintf(stderr, "[!] stack_create : invalid config\n");
-            free(stack);
             return NULL;
         }
 
+        dstack_t *stack = stack_mem_alloc(dconfig->allocator, sizeof(*stack));
+        if (!stack) return (perror("malloc failed"), NULL);
+
         if(dstack_init(stack, *dconfig)){
-            free(stack);
+            stack_mem_free(dconfig->allocator, stack);
+            return NULL;
+        }
+        
+        STACK_STATS_ALLOC(stack, sizeof(*stack));
+        return (stack_t*)stack;
+    }
+
+    if (type == STACK_TYPE_GROWABLE){
+        gstack_config_t *gconfig = (gstack_config_t*)config;
+        if (!gconfig){
+            fprintf(stderr, "[!] stack_create : invalid config\n");
+            return NULL;
+        }
+
+        gstack_t *stack = stack_mem_alloc(gconfig->allocator, sizeof(*stack));
+        if (!stack) return (perror("malloc failed"), NULL);
+
+        if(gstack_init(stack, *gconfig)){
+            stack_mem_free(gconfig->allocator, stack);
+            return NULL;
+        }
+        
+        STACK_STATS_ALLOC(stack, sizeof(*stack));
+        return (stack_t*)stack;
+    }
+    
+    if (type == STACK_TYPE_CONCURRENT){
+        cstack_config_t *cconfig = (cstack_config_t*)config;
+        if (!cconfig){
+            fprintf(stderr, "[!] stack_create : invalid config\n");
+            return NULL;
+        }
+
+        //top et free_list sont alignes sur une ligne de cache : malloc ne garantit que max_align_t
+        void *raw;
+        cstack_t *stack = stack_mem_alloc_aligned(cconfig->allocator, sizeof(*stack), _Alignof(cstack_t), &raw);
+        if (!stack) return (perror("malloc failed"), NULL);
+
+        if(cstack_init(stack, *cconfig)){
+            stack_mem_free(cconfig->allocator, raw);
+            return NULL;
+        }
+        stack->raw = raw;
+        
+        STACK_STATS_ALLOC(stack, sizeof(*stack));
+        return (stack_t*)stack;
+    }
+    
+    if (type == STACK_TYPE_WORK_STEALING){
+        wstack_config_t *wconfig = (wstack_config_t*)config;
+        if (!wconfig){
+            fprintf(stderr, "[!] stack_create : invalid config\n");
+            return NULL;
+        }
+
+        wstack_t *stack = stack_mem_alloc(wconfig->allocator, sizeof(*stack));
+        if (!stack) return (perror("malloc failed"), NULL);
+
+        if(wstack_init(stack, *wconfig)){
+            stack_mem_free(wconfig->allocator, stack);
+            return NULL;
+        }
+        
+        STACK_STATS_ALLOC(stack, sizeof(*stack));
+        return (stack_t*)stack;
+    }
+    
+    if (type == STACK_TYPE_MAPPED){
+        mstack_config_t *mconfig = (mstack_config_t*)config;
+        if (!mconfig){
+            fprintf(stderr, "[!] stack_create : invalid config\n");
+            return NULL;
+        }
+
+        mstack_t *stack = stack_mem_alloc(mconfig->allocator, sizeof(*stack));
+        if (!stack) return (perror("malloc failed"), NULL);
+
+        if(mstack_init(stack, *mconfig)){
+            stack_mem_free(mconfig->allocator, stack);
+            return NULL;
+        }
+        
+        STACK_STATS_ALLOC(stack, sizeof(*stack));
+        return (stack_t*)stack;
+    }
+    
+    if (type == STACK_TYPE_PERSISTENT){
+        pstack_config_t *pconfig = (pstack_config_t*)config;
+        if (!pconfig){
+            fprintf(stderr, "[!] stack_create : invalid config\n");
+            return NULL;
+        }
+
+        pstack_t *stack = stack_mem_alloc(pconfig->allocator, sizeof(*stack));
+        if (!stack) return (perror("malloc failed"), NULL);
+
+        if(pstack_init(stack, *pconfig)){
+            stack_mem_free(pconfig->allocator, stack);
+            return NULL;
+        }
+        
+        STACK_STATS_ALLOC(stack, sizeof(*stack));
+        return (stack_t*)stack;
+    }
+
+    if (type == STACK_TYPE_INDEXED){
+        istack_config_t *iconfig = (istack_config_t*)config;
+        if (!iconfig){
+            fprintf(stderr, "[!] stack_create : invalid config\n");
+            return NULL;
+        }
+
+        istack_t *stack = stack_mem_alloc(iconfig->allocator, sizeof(*stack));
+        if (!stack) return (perror("malloc failed"), NULL);
+
+        if(istack_init(stack, *iconfig)){
+            stack_mem_free(iconfig->allocator, stack);
+            return NULL;
+        }
+        
+        STACK_STATS_ALLOC(stack, sizeof(*stack));
+        return (stack_t*)stack;
+    }
+
+    if (type == STACK_TYPE_VARIABLE){
+        vstack_config_t *vconfig = (vstack_config_t*)config;
+        if (!vconfig){
+            fprintf(stderr, "[!] stack_create : invalid config\n");
+            return NULL;
+        }
+
+        vstack_t *stack = stack_mem_alloc(vconfig->allocator, sizeof(*stack));
+        if (!stack) return (perror("malloc failed"), NULL);
+
+        if(vstack_init(stack, *vconfig)){
+            stack_mem_free(vconfig->allocator, stack);
+            return NULL;
+        }
+        
+        STACK_STATS_ALLOC(stack, sizeof(*stack));
+        return (stack_t*)stack;
+    }
+
+    if (type == STACK_TYPE_RESERVED){
+        rstack_config_t *rconfig = (rstack_config_t*)config;
+        if (!rconfig){
+            fprintf(stderr, "[!] stack_create : invalid config\n");
+            return NULL;
+        }
+
+        rstack_t *stack = stack_mem_alloc(rconfig->allocator, sizeof(*stack));
+        if (!stack) return (perror("malloc failed"), NULL);
+
+        if(rstack_init(stack, *rconfig)){
+            stack_mem_free(rconfig->allocator, stack);
             return NULL;
         }
         
+        STACK_STATS_ALLOC(stack, sizeof(*stack));
         return (stack_t*)stack;
     }
     
@@ -49,6 +271,45 @@ stack_t* stack_create(stack_type_t type, void* config){
     return NULL;
 }
 
+size_t stack_init_in_bytes(stack_type_t type, const void* config){
+    if (type != STACK_TYPE_FIXED || !config) return 0;
+
+    //la pile commence a la premiere adresse de la zone alignee comme malloc
+    size_t bytes = fstack_storage_bytes(*(const fstack_config_t*)config);
+    if (!bytes || bytes > SIZE_MAX - (_Alignof(max_align_t) - 1)) return 0;
+
+    return bytes + _Alignof(max_align_t) - 1;
+}
+
+stack_t* stack_init_in(void* buffer, size_t bytes, stack_type_t type, void* config){
+    if (!buffer || !config){
+        fprintf(stderr, "[!] stack_init_in : invalid buffer or config\n");
+        return NULL;
+    }
+
+    if (type != STACK_TYPE_FIXED){
+        stack_report(STACK_ERR_UNSUPPORTED, "stack_init_in", true);
+        return NULL;
+    }
+
+    fstack_config_t fconfig = *(fstack_config_t*)config;
+    fconfig.allocator = &stack_in_place_allocator;
+
+    uintptr_t start = ((uintptr_t)buffer + _Alignof(max_align_t) - 1) & ~(uintptr_t)(_Alignof(max_align_t) - 1);
+    size_t offset = start - (uintptr_t)buffer;
+    size_t needed = fstack_storage_bytes(fconfig);
+
+    if (!needed || offset > bytes || bytes - offset < needed){
+        fprintf(stderr, "[!] stack_init_in : buffer is too small : %zu bytes needed\n", stack_init_in_bytes(type, config));
+        return NULL;
+    }
+
+    fstack_t *stack = (fstack_t*)start;
+    if (fstack_init(stack, fconfig, false)) return NULL;
+
+    return (stack_t*)stack;
+}
+
 void stack_destroy(stack_t** stack_ptr){
     if (!stack_ptr || !*stack_ptr){
         fprintf(stderr, "[!] stack_destroy : unable to destroy stack, stack is NULL or invalid\n");
@@ -69,7 +330,7 @@ int stack_push(stack_t* stack, void* val){
         fprintf(stderr, "[!] stack_push : pushing a NULL value into the stack (this may cause issues)\n");
     }
     
-    return stack->push(stack, val);
+    return stack_report(stack->push(stack, val), "stack_push", true);
 }
 
 void* stack_peek(stack_t* stack){
@@ -91,7 +352,13 @@ void* stack_pop(stack_t* stack, void* popped){
         fprintf(stderr, "[!] stack_pop : popping into a NULL value (this may be an unintended behavior)\n");
     }
     
-    return stack->pop(stack, popped);
+    //une pile vide n'est pas une erreur pour stack_pop : NULL suffit a la signaler
+    stack_error_t err = stack->pop(stack, popped);
+    if (err != STACK_OK){
+        if (err != STACK_ERR_EMPTY) stack_report(err, "stack_pop", true);
+        return NULL;
+    }
+    return popped;
 }
 
 bool stack_is_empty(stack_t* stack){
@@ -102,3 +369,519 @@ bool stack_is_empty(stack_t* stack){
     
     return stack->is_empty(stack);
 }
+
+static stack_error_t stack_push_n_impl(stack_t* stack, const void* vals, size_t n){
+    if (stack->push_n) return stack->push_n(stack, vals, n);
+
+    for (size_t i = 0; i < n; i++){
+        stack_error_t err = stack->push(stack, (char*)vals + i * stack->size);
+        if (err) return err;
+    }
+
+    return STACK_OK;
+}
+
+int stack_push_n(stack_t* stack, const void* vals, size_t n){
+    if (!stack){
+        fprintf(stderr, "[!] stack_push_n : unable to push, stack is NULL\n");
+        return 1;
+    }
+
+    if (n == 0) return 0;
+
+    if (!vals){
+        fprintf(stderr, "[!] stack_push_n : unable to push, values are NULL\n");
+        return 1;
+    }
+
+    return stack_report(stack_push_n_impl(stack, vals, n), "stack_push_n", true);
+}
+
+size_t stack_pop_n(stack_t* stack, void* out, size_t n, stack_order_t order){
+    if (!stack){
+        fprintf(stderr, "[!] stack_pop_n : unable to pop, stack is NULL\n");
+        return 0;
+    }
+
+    //sans taille d'element (pile d'enregistrements), la taille necessaire pour out n'est pas connue
+    if (out && stack->size == 0){
+        stack_report(STACK_ERR_UNSUPPORTED, "stack_pop_n", true);
+        return 0;
+    }
+
+    if (stack->pop_n) return stack->pop_n(stack, out, n, order);
+
+    size_t k = 0;
+    while (k < n){
+        //en ordre BOTTOM_UP on remplit out depuis la fin, l'ancien sommet se retrouve en dernier
+        size_t slot = order == STACK_ORDER_BOTTOM_UP ? n - 1 - k : k;
+        if (stack->pop(stack, out ? (char*)out + slot * stack->size : NULL) != STACK_OK) break;
+        k++;
+    }
+
+    if (out && order == STACK_ORDER_BOTTOM_UP && k < n)
+        memmove(out, (char*)out + (n - k) * stack->size, k * stack->size);
+
+    return k;
+}
+
+void* stack_emplace(stack_t* stack){
+    if (!stack){
+        fprintf(stderr, "[!] stack_emplace : unable to emplace, stack is NULL\n");
+        return NULL;
+    }
+
+    if (!stack->emplace){
+        fprintf(stderr, "[!] stack_emplace : unable to emplace, operation not supported by this stack type\n");
+        return NULL;
+    }
+
+    stack_error_t err = STACK_OK;
+    void *slot = stack->emplace(stack, &err);
+    if (!slot) stack_report(err, "stack_emplace", true);
+
+    return slot;
+}
+
+void* stack_pop_view(stack_t* stack){
+    if (!stack){
+        fprintf(stderr, "[!] stack_pop_view : unable to pop, stack is NULL\n");
+        return NULL;
+    }
+
+    if (!stack->pop_view){
+        fprintf(stderr, "[!] stack_pop_view : unable to pop, operation not supported by this stack type\n");
+        return NULL;
+    }
+
+    return stack->pop_view(stack);
+}
+
+void* stack_steal(stack_t* stack, void* stolen){
+    if (!stack){
+        fprintf(stderr, "[!] stack_steal : unable to steal, stack is NULL\n");
+        return NULL;
+    }
+
+    if (!stolen){
+        fprintf(stderr, "[!] stack_steal : unable to steal into a NULL value\n");
+        return NULL;
+    }
+
+    if (!stack->steal){
+        fprintf(stderr, "[!] stack_steal : unable to steal, operation not supported by this stack type\n");
+        return NULL;
+    }
+
+    return stack->steal(stack, stolen);
+}
+
+stack_t* stack_fork(stack_t* stack){
+    if (!stack){
+        fprintf(stderr, "[!] stack_fork : unable to fork, stack is NULL\n");
+        return NULL;
+    }
+
+    if (!stack->fork){
+        stack_report(STACK_ERR_UNSUPPORTED, "stack_fork", true);
+        return NULL;
+    }
+
+    stack_t *fork = stack->fork(stack);
+    if (!fork) stack_report(STACK_ERR_NO_MEMORY, "stack_fork", true);
+
+    return fork;
+}
+
+stack_error_t stack_push_record(stack_t* stack, const void* data, size_t len){
+    if (!stack || (!data && len)){
+        fprintf(stderr, "[!] stack_push_record : unable to push, stack or data is NULL\n");
+        return STACK_ERR_NULL;
+    }
+
+    if (!stack->emplace_record) return stack_report(STACK_ERR_UNSUPPORTED, "stack_push_record", true);
+
+    stack_error_t err = STACK_OK;
+    void *record = stack->emplace_record(stack, len, &err);
+    if (!record) return stack_report(err, "stack_push_record", true);
+
+    if (len) memcpy(record, data, len);
+    return STACK_OK;
+}
+
+stack_error_t stack_push_records(stack_t* stack, const void* data, const size_t* lens, size_t n){
+    if (!stack || (n && (!data || !lens))){
+        fprintf(stderr, "[!] stack_push_records : unable to push, stack, data or lens is NULL\n");
+        return STACK_ERR_NULL;
+    }
+
+    if (!stack->push_records) return stack_report(STACK_ERR_UNSUPPORTED, "stack_push_records", true);
+
+    return stack_report(stack->push_records(stack, data, lens, n), "stack_push_records", true);
+}
+
+void* stack_emplace_record(stack_t* stack, size_t len){
+    if (!stack){
+        fprintf(stderr, "[!] stack_emplace_record : unable to emplace, stack is NULL\n");
+        return NULL;
+    }
+
+    if (!stack->emplace_record){
+        stack_report(STACK_ERR_UNSUPPORTED, "stack_emplace_record", true);
+        return NULL;
+    }
+
+    stack_error_t err = STACK_OK;
+    void *record = stack->emplace_record(stack, len, &err);
+    if (!record) stack_report(err, "stack_emplace_record", true);
+
+    return record;
+}
+
+void* stack_peek_record(stack_t* stack, size_t* len){
+    if (!stack){
+        fprintf(stderr, "[!] stack_peek_record : unable to peek, stack is NULL\n");
+        return NULL;
+    }
+
+    if (!stack->peek_record){
+        stack_report(STACK_ERR_UNSUPPORTED, "stack_peek_record", true);
+        return NULL;
+    }
+
+    return stack->peek_record(stack, len);
+}
+
+stack_error_t stack_pop_record(stack_t* stack, void* out, size_t capacity, size_t* len){
+    if (!stack) return stack_report(STACK_ERR_NULL, "stack_pop_record", false);
+    if (!stack->peek_record) return stack_report(STACK_ERR_UNSUPPORTED, "stack_pop_record", false);
+
+    size_t record_len;
+    void *record = stack->peek_record(stack, &record_len);
+    if (!record) return stack_report(STACK_ERR_EMPTY, "stack_pop_record", false);
+
+    if (len) *len = record_len;
+    if (out && record_len > capacity) return stack_report(STACK_ERR_FULL, "stack_pop_record", false);
+
+    if (out) memcpy(out, record, record_len);
+    stack->pop(stack, NULL);
+
+    return STACK_OK;
+}
+
+void* stack_pop_record_view(stack_t* stack, size_t* len){
+    if (!stack){
+        fprintf(stderr, "[!] stack_pop_record_view : unable to pop, stack is NULL\n");
+        return NULL;
+    }
+
+    if (!stack->pop_record_view){
+        stack_report(STACK_ERR_UNSUPPORTED, "stack_pop_record_view", true);
+        return NULL;
+    }
+
+    return stack->pop_record_view(stack, len);
+}
+
+stack_error_t stack_pop_wait(stack_t* stack, void* popped, long timeout_ms){
+    if (!stack) return stack_report(STACK_ERR_NULL, "stack_pop_wait", true);
+    if (!stack->pop_wait) return stack_report(STACK_ERR_UNSUPPORTED, "stack_pop_wait", true);
+
+    return stack_report(stack->pop_wait(stack, popped, timeout_ms), "stack_pop_wait", false);
+}
+
+stack_error_t stack_push_wait(stack_t* stack, void* val, long timeout_ms){
+    if (!stack || !val) return stack_report(STACK_ERR_NULL, "stack_push_wait", true);
+    if (!stack->push_wait) return stack_report(STACK_ERR_UNSUPPORTED, "stack_push_wait", true);
+
+    return stack_report(stack->push_wait(stack, val, timeout_ms), "stack_push_wait", false);
+}
+
+void stack_close(stack_t* stack){
+    if (!stack){
+        fprintf(stderr, "[!] stack_close : unable to close, stack is NULL\n");
+        return;
+    }
+
+    if (!stack->close){
+        stack_report(STACK_ERR_UNSUPPORTED, "stack_close", true);
+        return;
+    }
+
+    stack->close(stack);
+}
+
+size_t stack_shrink_to_fit(stack_t* stack){
+    if (!stack){
+        fprintf(stderr, "[!] stack_shrink_to_fit : unable to shrink, stack is NULL\n");
+        return 0;
+    }
+
+    if (!stack->shrink){
+        stack_report(STACK_ERR_UNSUPPORTED, "stack_shrink_to_fit", true);
+        return 0;
+    }
+
+    return stack->shrink(stack);
+}
+
+size_t stack_size(stack_t* stack){
+    if (!stack){
+        fprintf(stderr, "[!] stack_size : unable to get size, stack is NULL\n");
+        return 0;
+    }
+
+    if (!stack->count){
+        stack_report(STACK_ERR_UNSUPPORTED, "stack_size", true);
+        return 0;
+    }
+
+    return stack->count(stack);
+}
+
+void* stack_at(stack_t* stack, size_t depth){
+    if (!stack){
+        fprintf(stderr, "[!] stack_at : unable to access, stack is NULL\n");
+        return NULL;
+    }
+
+    if (!stack->at){
+        stack_report(STACK_ERR_UNSUPPORTED, "stack_at", true);
+        return NULL;
+    }
+
+    return stack->at(stack, depth);
+}
+
+stack_error_t stack_foreach(stack_t* stack, stack_order_t order, stack_visitor_t visit, void* ctx){
+    if (!stack || !visit){
+        fprintf(stderr, "[!] stack_foreach : unable to iterate, stack or visit is NULL\n");
+        return STACK_ERR_NULL;
+    }
+
+    if (!stack->foreach) return stack_report(STACK_ERR_UNSUPPORTED, "stack_foreach", true);
+
+    return stack_report(stack->foreach(stack, order, visit, ctx), "stack_foreach", true);
+}
+
+typedef struct {
+    const void *val;
+    size_t size;
+    void *found;
+} stack_find_ctx_t;
+
+static bool stack_find_visit(void* elem, void* ctx){
+    stack_find_ctx_t *find = ctx;
+    if (memcmp(elem, find->val, find->size)) return true;
+
+    find->found = elem;
+    return false;
+}
+
+void* stack_find(stack_t* stack, const void* val){
+    if (!stack || !val){
+        fprintf(stderr, "[!] stack_find : unable to search, stack or val is NULL\n");
+        return NULL;
+    }
+
+    if (stack->find) return stack->find(stack, val);
+
+    //sans taille d'element (STACK_TYPE_VARIABLE), il n'y a rien a comparer
+    if (!stack->foreach || stack->size == 0){
+        stack_report(STACK_ERR_UNSUPPORTED, "stack_find", true);
+        return NULL;
+    }
+
+    //parcours du sommet vers le fond : le premier element egal est le plus proche du sommet
+    stack_find_ctx_t find = {.val = val, .size = stack->size, .found = NULL};
+    if (stack_report(stack->foreach(stack, STACK_ORDER_TOP_DOWN, stack_find_visit, &find), "stack_find", true))
+        return NULL;
+
+    return find.found;
+}
+
+bool stack_contains(stack_t* stack, const void* val){
+    if (!stack || !val){
+        fprintf(stderr, "[!] stack_contains : unable to search, stack or val is NULL\n");
+        return false;
+    }
+
+    if (stack->contains) return stack->contains(stack, val);
+
+    return stack_find(stack, val) != NULL;
+}
+
+stack_mark_t stack_mark(stack_t* stack){
+    if (!stack){
+        fprintf(stderr, "[!] stack_mark : unable to mark, stack is NULL\n");
+        return 0;
+    }
+
+    if (!stack->truncate || !stack->count){
+        stack_report(STACK_ERR_UNSUPPORTED, "stack_mark", true);
+        return 0;
+    }
+
+    return stack->count(stack);
+}
+
+stack_error_t stack_rollback(stack_t* stack, stack_mark_t mark){
+    if (!stack){
+        fprintf(stderr, "[!] stack_rollback : unable to rollback, stack is NULL\n");
+        return STACK_ERR_NULL;
+    }
+
+    if (!stack->truncate || !stack->count) return stack_report(STACK_ERR_UNSUPPORTED, "stack_rollback", true);
+
+    if (mark > stack->count(stack)) return stack_report(STACK_ERR_RANGE, "stack_rollback", true);
+
+    stack->truncate(stack, mark);
+    return STACK_OK;
+}
+
+void stack_clear(stack_t* stack){
+    if (!stack){
+        fprintf(stderr, "[!] stack_clear : unable to clear, stack is NULL\n");
+        return;
+    }
+
+    if (stack->truncate){
+        stack->truncate(stack, 0);
+        return;
+    }
+
+    while (stack->pop(stack, NULL) == STACK_OK);
+}
+
+stack_error_t stack_save(stack_t* stack, FILE* file){
+    if (!stack || !file){
+        fprintf(stderr, "[!] stack_save : unable to save, stack or file is NULL\n");
+        return STACK_ERR_NULL;
+    }
+
+    if (!stack->save || !stack->count) return stack_report(STACK_ERR_UNSUPPORTED, "stack_save", true);
+
+    stack_snapshot_header_t header = {
+        .magic = STACK_SNAPSHOT_MAGIC,
+        .version = STACK_SNAPSHOT_VERSION,
+        .type = (uint32_t)stack->type,
+        .size = stack->size,
+        .count = stack->count(stack)
+    };
+
+    if (fwrite(&header, sizeof(header), 1, file) != 1) return stack_report(STACK_ERR_IO, "stack_save", true);
+
+    return stack_report(stack->save(stack, file), "stack_save", true);
+}
+
+//Ajoute count elements lus dans file par lots de STACK_LOAD_BUFFER_BYTES, avec push_n
+static stack_error_t stack_load_generic(stack_t* stack, FILE* file, size_t count){
+    size_t batch = STACK_LOAD_BUFFER_BYTES / stack->size;
+    if (batch == 0) batch = 1;
+    if (batch > count) batch = count;
+
+    void *buffer = stack_mem_alloc(stack->allocator, batch * stack->size);
+    if (!buffer) return STACK_ERR_NO_MEMORY;
+
+    stack_error_t err = STACK_OK;
+    while (count && !err){
+        size_t k = count < batch ? count : batch;
+        if (fread(buffer, stack->size, k, file) != k) err = STACK_ERR_IO;
+        else err = stack_push_n_impl(stack, buffer, k);
+        count -= k;
+    }
+
+    stack_mem_free(stack->allocator, buffer);
+    return err;
+}
+
+stack_error_t stack_load(stack_t* stack, FILE* file){
+    if (!stack || !file){
+        fprintf(stderr, "[!] stack_load : unable to load, stack or file is NULL\n");
+        return STACK_ERR_NULL;
+    }
+
+    stack_snapshot_header_t header;
+    if (fread(&header, sizeof(header), 1, file) != 1
+        || header.magic != STACK_SNAPSHOT_MAGIC || header.version != STACK_SNAPSHOT_VERSION)
+        return stack_report(STACK_ERR_IO, "stack_load", true);
+
+    if (header.size != stack->size){
+        fprintf(stderr, "[!] stack_load : unable to load, snapshot element size (%llu) does not match stack size (%zu)\n",
+                (unsigned long long)header.size, stack->size);
+        return STACK_ERR_IO;
+    }
+
+    if (header.count > SIZE_MAX) return stack_report(STACK_ERR_FULL, "stack_load", true);
+    if (header.count == 0) return STACK_OK;
+
+    size_t count = (size_t)header.count;
+    stack_error_t err = stack->load ? stack->load(stack, file, count) : stack_load_generic(stack, file, count);
+
+    return stack_report(err, "stack_load", true);
+}
+
+#ifdef STACK_STATS
+stack_stats_t stack_get_stats(stack_t* stack){
+    if (!stack){
+        fprintf(stderr, "[!] stack_get_stats : unable to get stats, stack is NULL\n");
+        return (stack_stats_t){0};
+    }
+
+    return (stack_stats_t){
+        .pushes = atomic_load_explicit(&stack->stats.pushes, memory_order_relaxed),
+        .pops = atomic_load_explicit(&stack->stats.pops, memory_order_relaxed),
+        .failed_pushes = atomic_load_explicit(&stack->stats.failed_pushes, memory_order_relaxed),
+        .high_water = atomic_load_explicit(&stack->stats.high_water, memory_order_relaxed),
+        .depth = atomic_load_explicit(&stack->stats.depth, memory_order_relaxed),
+        .bytes_allocated = atomic_load_explicit(&stack->stats.bytes_allocated, memory_order_relaxed),
+        .allocator_calls = atomic_load_explicit(&stack->stats.allocator_calls, memory_order_relaxed),
+        .bytes_trimmed = atomic_load_explicit(&stack->stats.bytes_trimmed, memory_order_relaxed)
+    };
+}
+#endif
+
+void stack_set_error_handler(stack_error_handler_t handler, void* ctx){
+    error_handler = handler;
+    error_handler_ctx = ctx;
+}
+
+const char* stack_strerror(stack_error_t err){
+    switch (err){
+        case STACK_OK: return "no error";
+        case STACK_ERR_NULL: return "stack or argument is NULL";
+        case STACK_ERR_FULL: return "stack is full";
+        case STACK_ERR_EMPTY: return "stack is empty";
+        case STACK_ERR_NO_MEMORY: return "memory allocation failed";
+        case STACK_ERR_UNSUPPORTED: return "operation not supported by this stack type";
+        case STACK_ERR_IO: return "read or write failed, or invalid snapshot";
+        case STACK_ERR_CLOSED: return "stack is closed";
+        case STACK_ERR_RANGE: return "argument is out of the stack range";
+    }
+
+    return "unknown error";
+}
+
+stack_error_t stack_try_push(stack_t* stack, void* val){
+    if (!stack || !val) return stack_report(STACK_ERR_NULL, "stack_try_push", false);
+    return stack_report(stack->push(stack, val), "stack_try_push", false);
+}
+
+stack_error_t stack_try_pop(stack_t* stack, void* popped){
+    if (!stack) return stack_report(STACK_ERR_NULL, "stack_try_pop", false);
+    return stack_report(stack->pop(stack, popped), "stack_try_pop", false);
+}
+
+stack_error_t stack_try_peek(stack_t* stack, void** top){
+    if (!stack || !top) return stack_report(STACK_ERR_NULL, "stack_try_peek", false);
+
+    *top = stack->peek(stack);
+    return *top ? STACK_OK : stack_report(STACK_ERR_EMPTY, "stack_try_peek", false);
+}
+
+stack_error_t stack_try_push_n(stack_t* stack, const void* vals, size_t n){
+    if (!stack || (!vals && n)) return stack_report(STACK_ERR_NULL, "stack_try_push_n", false);
+    if (n == 0) return STACK_OK;
+
+    return stack_report(stack_push_n_impl(stack, vals, n), "stack_try_push_n", false);
+}
@@ -1,56 +1,476 @@
 #ifndef __STACK_H__
 #define __STACK_H__
 
+#include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdio.h>
 
+#ifdef STACK_STATS
+#include <stdatomic.h>
+#endif
+
+// Peuvent etre definis a false avant l'inclusion (ou avec -D) pour desactiver ces warnings
+#ifndef WARN_STACK_POP_INTO_NULL
 #define WARN_STACK_POP_INTO_NULL true
+#endif
+#ifndef WARN_STACK_PUSH_NULL
 #define WARN_STACK_PUSH_NULL true
+#endif
+
+// Capacite gardee apres un trim automatique si stack_trim_policy_t.headroom vaut 0 (en multiple du nombre d'elements)
+#define STACK_TRIM_DEFAULT_HEADROOM 2.0
+
+// Nombre d'elements par bloc d'une pile dynamique si dstack_config_t.chunk_length vaut 0
+#define DSTACK_DEFAULT_CHUNK_LENGTH 256
+
+// Valeurs par defaut d'une pile extensible si les champs de gstack_config_t valent 0
+#define GSTACK_DEFAULT_INITIAL_LENGTH 16
+#define GSTACK_DEFAULT_GROWTH_FACTOR 2.0
+
+// Nombre de noeuds prealloues par une pile concurrente si cstack_config_t.initial_length vaut 0
+#define CSTACK_DEFAULT_INITIAL_LENGTH 64
+// Nombre d'iterations d'attente d'un push dans le tableau d'elimination si cstack_config_t.elimination_spins vaut 0
+#define CSTACK_DEFAULT_ELIMINATION_SPINS 128
+
+// Capacite initiale d'une pile a vol de travail si wstack_config_t.initial_length vaut 0
+#define WSTACK_DEFAULT_INITIAL_LENGTH 64
+
+// Capacite initiale d'une pile projetee en memoire si mstack_config_t.initial_length vaut 0
+#define MSTACK_DEFAULT_INITIAL_LENGTH 1024
+
+// Valeurs par defaut d'une pile a plage reservee si les champs de rstack_config_t valent 0
+#define RSTACK_DEFAULT_RESERVE_BYTES ((size_t)1 << 30)
+#define RSTACK_DEFAULT_COMMIT_BYTES ((size_t)64 << 10)
+#define RSTACK_DEFAULT_DECOMMIT_BYTES ((size_t)1 << 20)
+
+// Taille initiale en octets du tableau d'une pile d'enregistrements si vstack_config_t.initial_bytes vaut 0
+#define VSTACK_DEFAULT_INITIAL_BYTES 4096
+
+// Nombre de valeurs distinctes prevues par l'index d'une pile indexee si istack_config_t.initial_capacity vaut 0
+#define ISTACK_DEFAULT_INITIAL_CAPACITY 64
 
 // Les différents types de stack
 // STACK_TYPE_FIXED: stack avec une taille fixe - approche tableau
-// STACK_TYPE_DYNAMIC: stack avec une taille dynamique - approche liste chaînée
+// STACK_TYPE_DYNAMIC: stack avec une taille dynamique - approche liste chaînée de blocs contigus
+// STACK_TYPE_GROWABLE: stack avec une taille dynamique - approche tableau realloue geometriquement
+// STACK_TYPE_CONCURRENT: stack thread-safe sans verrou - pile de Treiber
+// STACK_TYPE_WORK_STEALING: stack d'un seul proprietaire ou d'autres threads peuvent voler le fond - deque de Chase-Lev
+// STACK_TYPE_MAPPED: stack adossee a un fichier - approche tableau dans un fichier projete en memoire (mmap)
+// STACK_TYPE_PERSISTENT: stack a structure partagee - liste chainee de noeuds partages entre les versions (stack_fork en O(1))
+// STACK_TYPE_INDEXED: stack d'un autre type doublee d'un index des valeurs presentes (stack_contains en O(1))
+// STACK_TYPE_VARIABLE: stack d'enregistrements de taille variable - approche tableau d'enregistrements colles les uns aux autres
+// STACK_TYPE_RESERVED: stack avec une taille dynamique - approche tableau dans une plage d'adresses reservee (jamais deplace)
 typedef enum {
     STACK_TYPE_FIXED,
     STACK_TYPE_DYNAMIC,
+    STACK_TYPE_GROWABLE,
+    STACK_TYPE_CONCURRENT,
+    STACK_TYPE_WORK_STEALING,
+    STACK_TYPE_MAPPED,
+    STACK_TYPE_PERSISTENT,
+    STACK_TYPE_INDEXED,
+    STACK_TYPE_VARIABLE,
+    STACK_TYPE_RESERVED,
 } stack_type_t;
 
+// Les codes d'erreur des operations sur une pile (0 = succes)
+// STACK_ERR_NULL: la pile ou la valeur passee est NULL
+// STACK_ERR_FULL: la pile a atteint sa capacite maximale
+// STACK_ERR_EMPTY: la pile est vide
+// STACK_ERR_NO_MEMORY: une allocation a echoue
+// STACK_ERR_UNSUPPORTED: l'operation n'est pas supportee par ce type de pile
+// STACK_ERR_IO: une lecture ou une ecriture a echoue, ou le snapshot est invalide
+// STACK_ERR_CLOSED: la pile a ete fermee par stack_close
+// STACK_ERR_RANGE: un argument depasse la profondeur de la pile (point de reprise trop haut)
+typedef enum {
+    STACK_OK = 0,
+    STACK_ERR_NULL,
+    STACK_ERR_FULL,
+    STACK_ERR_EMPTY,
+    STACK_ERR_NO_MEMORY,
+    STACK_ERR_UNSUPPORTED,
+    STACK_ERR_IO,
+    STACK_ERR_CLOSED,
+    STACK_ERR_RANGE,
+} stack_error_t;
+
+///@brief Une fonction appelee a chaque erreur (voir stack_set_error_handler)
+///@param err: Le code d'erreur
+///@param where: Le nom de la fonction de l'API qui a echoue
+///@param ctx: Le contexte passe a stack_set_error_handler
+typedef void (*stack_error_handler_t)(stack_error_t err, const char* where, void* ctx);
+
+// L'ordre dans lequel les elements sont ecrits ou parcourus
+// STACK_ORDER_TOP_DOWN: du sommet vers le fond (ordre LIFO)
+// STACK_ORDER_BOTTOM_UP: du fond vers le sommet (ordre dans lequel les elements ont ete ajoutes)
+typedef enum {
+    STACK_ORDER_TOP_DOWN,
+    STACK_ORDER_BOTTOM_UP,
+} stack_order_t;
+
+///@brief Une fonction appelee sur chaque element par stack_foreach
+///@param elem: L'element (dans le stockage de la pile)
+///@param ctx: Le contexte passe a stack_foreach
+///@return true pour continuer le parcours, false pour l'arreter
+typedef bool (*stack_visitor_t)(void* elem, void* ctx);
+
+// Le timeout de stack_pop_wait et stack_push_wait pour attendre sans limite
+#define STACK_WAIT_FOREVER (-1L)
+
+// Un point de reprise retourne par stack_mark : le nombre d'elements de la pile au moment de l'appel
+typedef size_t stack_mark_t;
+
+///@brief Un allocateur personnalise utilise pour toute la memoire d'une pile
+///@param alloc: Alloue bytes octets (retourne NULL en cas d'echec)
+///@param realloc: Redimensionne un bloc alloue par alloc (retourne NULL en cas d'echec)
+///@param free: Libere un bloc alloue par alloc ou realloc
+///@param ctx: Un contexte utilisateur passe a chaque appel (arena, pool, ...)
+///@note Les trois fonctions doivent etre fournies
+typedef struct _stack_allocator_t{
+    void* (*alloc)(void* ctx, size_t bytes);
+    void* (*realloc)(void* ctx, void* ptr, size_t bytes);
+    void (*free)(void* ctx, void* ptr);
+    void* ctx;
+} stack_allocator_t;
+
+///@brief Un pool de blocs de taille fixe, recycles via une liste libre (voir stack_pool_create)
+typedef struct _stack_pool_t stack_pool_t;
+
+///@brief Une politique de trim automatique : rend la memoire inutilisee apres une baisse de la profondeur de la pile
+///@param low_watermark: Un pop qui fait passer le nombre d'elements sous low_watermark * capacite declenche un trim
+///                      (0 = desactive, sinon entre 0 et 1)
+///@param headroom: Apres un trim, la capacite gardee est headroom * nombre d'elements (0 = STACK_TRIM_DEFAULT_HEADROOM, >= 1)
+///@param min_bytes: Le nombre minimal d'octets a rendre pour qu'un trim ait lieu (0 = aucun minimum)
+///
+///@note low_watermark * headroom doit etre < 1 : apres un trim, la pile doit encore perdre des elements pour en declencher
+///      un autre et en gagner pour s'agrandir, elle n'oscille pas entre les deux
+typedef struct _stack_trim_policy_t{
+    double low_watermark;
+    double headroom;
+    size_t min_bytes;
+} stack_trim_policy_t;
+
 ///@brief La configuration d'une pile avec une taille fixe
 ///@param length: La taille de la pile
 ///@param size: La taille d'un element de la pile
+///@param allocator: L'allocateur a utiliser (NULL = malloc/calloc/free)
+///@param alignment: L'alignement du tableau en octets, une puissance de 2 (0 = alignement de malloc, 64 = une ligne de cache)
+///@param huge_pages: Conseille au noyau d'utiliser des pages de 2 Mo (madvise MADV_HUGEPAGE, tableau aligne sur 2 Mo s'il est assez grand)
+///@param prefault: Touche chaque page du tableau a la creation pour que les premiers push ne fassent pas de defaut de page
+///@param lock: Verrouille le tableau en memoire (mlock), la creation echoue si la limite RLIMIT_MEMLOCK est depassee
+///@param no_zero: Ne met pas le tableau a zero (le contenu initial est indetermine)
+///@param trim: La politique de trim automatique (la capacite est le nombre d'elements dont les pages ont pu etre touchees,
+///             les pages au-dela de la capacite gardee sont rendues avec madvise(MADV_DONTNEED), le tableau ne change pas)
 typedef struct _fstack_config_t{
     size_t length;
     size_t size;
+    const stack_allocator_t *allocator;
+    size_t alignment;
+    bool huge_pages;
+    bool prefault;
+    bool lock;
+    bool no_zero;
+    stack_trim_policy_t trim;
 } fstack_config_t;
 
 ///@brief La configuration d'une pile avec une taille dynamique
 ///@param size: La taille d'un element de la pile
+///@param chunk_length: Le nombre d'elements par bloc (0 = DSTACK_DEFAULT_CHUNK_LENGTH)
+///@param allocator: L'allocateur a utiliser (NULL = malloc/free)
+///@param pool: Un pool dans lequel recycler les blocs (NULL = les blocs viennent de allocator)
+///
+///@note Un meme pool peut etre partage par plusieurs piles avec la meme configuration,
+///      il doit etre detruit apres toutes les piles qui l'utilisent
 typedef struct _dstack_config_t{
     size_t size;
+    size_t chunk_length;
+    const stack_allocator_t *allocator;
+    stack_pool_t *pool;
 } dstack_config_t;
 
+///@brief La configuration d'une pile extensible
+///@param size: La taille d'un element de la pile
+///@param initial_length: La capacite initiale de la pile (0 = GSTACK_DEFAULT_INITIAL_LENGTH)
+///@param max_length: La capacite maximale de la pile (0 = pas de limite)
+///@param growth_factor: Le facteur d'agrandissement du tableau, doit etre > 1 (0 = GSTACK_DEFAULT_GROWTH_FACTOR)
+///@param allocator: L'allocateur a utiliser (NULL = malloc/realloc/free)
+///@param trim: La politique de trim automatique (le tableau est reduit avec realloc)
+typedef struct _gstack_config_t{
+    size_t size;
+    size_t initial_length;
+    size_t max_length;
+    double growth_factor;
+    const stack_allocator_t *allocator;
+    stack_trim_policy_t trim;
+} gstack_config_t;
+
+///@brief La configuration d'une pile concurrente (thread-safe, sans verrou)
+///@param size: La taille d'un element de la pile
+///@param initial_length: Le nombre de noeuds prealloues (0 = CSTACK_DEFAULT_INITIAL_LENGTH, arrondi a une puissance de 2)
+///@param allocator: L'allocateur a utiliser (NULL = malloc/free), il doit etre thread-safe
+///@param elimination_slots: La taille du tableau d'elimination (0 = desactive)
+///@param elimination_adaptive: Ajuste le nombre de cases utilisees selon la contention (sinon toutes les cases sont utilisees)
+///@param elimination_spins: Le nombre d'iterations pendant lesquelles un push attend un pop dans une case (0 = CSTACK_DEFAULT_ELIMINATION_SPINS)
+///@param max_length: Le nombre maximal d'elements (0 = sans limite), un push sur une pile pleine retourne STACK_ERR_FULL
+///                   et stack_push_wait attend qu'un pop libere une place
+///
+///@note Les noeuds ne sont jamais rendus a l'allocateur avant la destruction de la pile,
+///      ils sont recycles dans une liste libre (la memoire reste valide, voir cstack.c)
+///@note Avec l'elimination, un push et un pop qui echouent leur CAS sur le sommet peuvent s'echanger
+///      l'element directement dans le tableau d'elimination, sans toucher au sommet
+typedef struct _cstack_config_t{
+    size_t size;
+    size_t initial_length;
+    const stack_allocator_t *allocator;
+    size_t elimination_slots;
+    bool elimination_adaptive;
+    size_t elimination_spins;
+    size_t max_length;
+} cstack_config_t;
+
+///@brief La configuration d'une pile a vol de travail (work-stealing)
+///@param size: La taille d'un element de la pile
+///@param initial_length: La capacite initiale (0 = WSTACK_DEFAULT_INITIAL_LENGTH, arrondi a une puissance de 2)
+///@param allocator: L'allocateur a utiliser (NULL = malloc/free)
+///
+///@note Seul le thread proprietaire peut utiliser push, pop et peek (sans contention sur le sommet),
+///      les autres threads retirent les elements les plus anciens avec stack_steal
+///@note Le tableau est double lorsqu'il est plein, les anciens tableaux sont gardes jusqu'a la destruction
+typedef struct _wstack_config_t{
+    size_t size;
+    size_t initial_length;
+    const stack_allocator_t *allocator;
+} wstack_config_t;
+
+///@brief La configuration d'une pile projetee en memoire depuis un fichier
+///@param path: Le chemin du fichier (cree s'il n'existe pas)
+///@param size: La taille d'un element de la pile
+///@param initial_length: La capacite initiale d'un nouveau fichier (0 = MSTACK_DEFAULT_INITIAL_LENGTH)
+///@param allocator: L'allocateur de la structure de la pile (NULL = malloc/free), les elements sont dans le fichier
+///
+///@note Si le fichier contient deja une pile, elle est rouverte telle quelle en O(1) (sans lire les elements) :
+///      size doit alors etre la taille d'element avec laquelle le fichier a ete cree
+///@note La capacite double lorsque la pile est pleine (ftruncate + mremap), le fichier n'est jamais reduit
+///@note Le fichier est garde a la destruction de la pile, les ecritures sont visibles par le noyau des qu'elles sont faites
+///      (elles survivent a un crash du processus, pas a une coupure de courant sans msync)
+typedef struct _mstack_config_t{
+    const char *path;
+    size_t size;
+    size_t initial_length;
+    const stack_allocator_t *allocator;
+} mstack_config_t;
+
+///@brief La configuration d'une pile persistante (a structure partagee)
+///@param size: La taille d'un element de la pile
+///@param allocator: L'allocateur a utiliser (NULL = malloc/free)
+///@param pool: Un pool dans lequel recycler les noeuds (NULL = les noeuds viennent de allocator)
+///
+///@note Chaque element est un noeud compte par reference : stack_fork cree en O(1) une nouvelle version
+///      qui partage tous ses noeuds avec l'originale, seuls les noeuds ajoutes ensuite lui sont propres
+///@note Les versions peuvent etre utilisees par des threads differents (compteurs atomiques),
+///      sauf avec un pool, qui n'est pas thread-safe
+typedef struct _pstack_config_t{
+    size_t size;
+    const stack_allocator_t *allocator;
+    stack_pool_t *pool;
+} pstack_config_t;
+
+///@brief La configuration d'une pile a plage d'adresses reservee
+///@param size: La taille d'un element de la pile
+///@param max_length: Le nombre maximal d'elements, la plage reservee d'emblee (0 = RSTACK_DEFAULT_RESERVE_BYTES / size)
+///@param commit_bytes: Le nombre d'octets rendus accessibles a la fois quand le sommet depasse les pages accessibles
+///                     (0 = RSTACK_DEFAULT_COMMIT_BYTES, arrondi a la taille d'une page)
+///@param decommit_bytes: La marge gardee au-dessus du sommet : les pages sont liberees quand plus de deux marges
+///                       sont inutilisees (0 = RSTACK_DEFAULT_DECOMMIT_BYTES, arrondi a la taille d'une page)
+///@param allocator: L'allocateur de la structure de la pile (NULL = malloc/free), le tableau vient de mmap
+///
+///@note La plage est reservee avec mmap(PROT_NONE) et ne consomme pas de memoire : les pages sont rendues
+///      accessibles (mprotect) au fur et a mesure des push et liberees (madvise) apres des pop profonds
+///@note Le tableau n'est jamais deplace ni recopie : les adresses retournees par stack_peek restent valides
+///      tant que l'element est dans la pile
+typedef struct _rstack_config_t{
+    size_t size;
+    size_t max_length;
+    size_t commit_bytes;
+    size_t decommit_bytes;
+    const stack_allocator_t *allocator;
+} rstack_config_t;
+
+///@brief La configuration d'une pile d'enregistrements de taille variable
+///@param initial_bytes: La taille initiale du tableau en octets, il double quand il est plein (0 = VSTACK_DEFAULT_INITIAL_BYTES)
+///@param alignment: L'alignement du debut de chaque enregistrement, puissance de 2 entre sizeof(size_t) et
+///                  _Alignof(max_align_t) (0 = sizeof(size_t))
+///@param allocator: L'allocateur a utiliser (NULL = malloc/free)
+///@param trim: La politique de trim automatique (capacite et nombre d'elements en octets, le tableau est reduit avec realloc)
+///
+///@note Chaque enregistrement occupe ses octets plus sa longueur (un size_t), arrondis a alignment
+///@note La pile n'a pas de taille d'element (size = 0) : les enregistrements s'ajoutent avec stack_push_record,
+///      stack_emplace_record ou stack_push_records, stack_push et stack_push_n retournent STACK_ERR_UNSUPPORTED
+///@note stack_pop et stack_pop_n ne connaissent pas la taille du tampon : ils retournent STACK_ERR_UNSUPPORTED (ou 0)
+///      si popped ou out n'est pas NULL et ne font que retirer sinon. Les enregistrements se copient avec
+///      stack_pop_record (borne a la taille du tampon) ou se lisent sur place avec stack_pop_record_view
+///@note stack_peek, stack_at et stack_foreach donnent l'adresse des enregistrements, stack_peek_record aussi leur longueur
+typedef struct _vstack_config_t{
+    size_t initial_bytes;
+    size_t alignment;
+    const stack_allocator_t *allocator;
+    stack_trim_policy_t trim;
+} vstack_config_t;
+
+///@brief La configuration d'une pile indexee
+///@param type: Le type de la pile qui stocke les elements (STACK_TYPE_FIXED, DYNAMIC, GROWABLE, MAPPED, PERSISTENT ou RESERVED)
+///@param config: La configuration de cette pile (fstack_config_t*, dstack_config_t*, ...)
+///@param initial_capacity: Le nombre de valeurs distinctes prevues, l'index s'agrandit au-dela (0 = ISTACK_DEFAULT_INITIAL_CAPACITY)
+///@param bloom_counters: Le nombre de compteurs du filtre de Bloom consulte avant l'index (0 = pas de filtre)
+///@param allocator: L'allocateur de la pile indexee et de son index (NULL = malloc/free)
+///
+///@note Chaque push et chaque pop met a jour un multi-ensemble (table de hachage) des valeurs presentes,
+///      cle = les size octets de l'element : stack_contains repond en O(1) au lieu de parcourir la pile
+///@note Le filtre de Bloom (compteurs de 8 bits, arrondi a une puissance de 2) repond non sans toucher a la table
+///      pour la plupart des valeurs absentes : utile quand la table ne tient pas dans le cache
+///@note emplace, steal et fork ne sont pas supportes (la valeur ajoutee n'est pas connue a l'appel)
+typedef struct _istack_config_t{
+    stack_type_t type;
+    void *config;
+    size_t initial_capacity;
+    size_t bloom_counters;
+    const stack_allocator_t *allocator;
+} istack_config_t;
+
+#ifdef STACK_STATS
+///@brief Les statistiques d'une pile (voir stack_get_stats)
+///@param pushes: Le nombre d'elements ajoutes (push, push_n, emplace, load)
+///@param pops: Le nombre d'elements retires (pop, pop_n, pop_view, steal)
+///@param failed_pushes: Le nombre d'ajouts refuses (pile pleine ou allocation echouee)
+///@param high_water: Le nombre maximal d'elements atteint
+///@param depth: Le nombre d'elements actuel
+///@param bytes_allocated: Les octets actuellement alloues pour les elements et la structure de la pile
+///@param bytes_trimmed: Les octets rendus par stack_shrink_to_fit et par les trims automatiques
+///@param allocator_calls: Le nombre d'appels a l'allocateur, au pool ou a mmap/mremap (liberations comprises)
+typedef struct _stack_stats_t{
+    size_t pushes;
+    size_t pops;
+    size_t failed_pushes;
+    size_t high_water;
+    size_t depth;
+    size_t bytes_allocated;
+    size_t allocator_calls;
+    size_t bytes_trimmed;
+} stack_stats_t;
+
+// Les compteurs d'une pile, mis a jour avec des atomiques relaxed (voir stats.h)
+typedef struct _stack_counters_t{
+    _Atomic size_t pushes;
+    _Atomic size_t pops;
+    _Atomic size_t failed_pushes;
+    _Atomic size_t high_water;
+    _Atomic size_t depth;
+    _Atomic size_t bytes_allocated;
+    _Atomic size_t allocator_calls;
+    _Atomic size_t bytes_trimmed;
+} stack_counters_t;
+#endif
+
 ///@brief La structure d'une pile generique
-///@param type: Le type de la pile (STACK_TYPE_FIXED ou STACK_TYPE_DYNAMIC)
+///@param type: Le type de la pile (voir stack_type_t)
 ///@param size: La taille d'un element de la pile
+///@param allocator: L'allocateur de la pile (NULL = malloc/free)
 typedef struct _stack_t{
     stack_type_t type;
     size_t size;
+    const stack_allocator_t *allocator;
     
+    // Les operations ne font aucune entree/sortie : les erreurs sont retournees sous forme de stack_error_t
     void (*destroy)(struct _stack_t** self_ptr);
-    int (*push)(struct _stack_t* self, void* val);
+    stack_error_t (*push)(struct _stack_t* self, void* val);
     void* (*peek)(struct _stack_t* self);
-    void* (*pop)(struct _stack_t* self, void* popped);
+    stack_error_t (*pop)(struct _stack_t* self, void* popped);
     bool (*is_empty)(struct _stack_t* self);
+
+    // Operations optionnelles (NULL = implementation generique, ou non supportee pour emplace/pop_view/steal)
+    stack_error_t (*push_n)(struct _stack_t* self, const void* vals, size_t n);
+    size_t (*pop_n)(struct _stack_t* self, void* out, size_t n, stack_order_t order);
+    // emplace retourne NULL en cas d'echec et ecrit la cause dans *err (STACK_ERR_FULL ou STACK_ERR_NO_MEMORY)
+    void* (*emplace)(struct _stack_t* self, stack_error_t* err);
+    void* (*pop_view)(struct _stack_t* self);
+    void* (*steal)(struct _stack_t* self, void* stolen);
+    struct _stack_t* (*fork)(struct _stack_t* self);
+
+    // Snapshot (NULL = non supporte pour count/save, implementation generique par lots pour load)
+    // count retourne le nombre d'elements, save les ecrit du fond vers le sommet, load ajoute count elements lus dans file
+    size_t (*count)(struct _stack_t* self);
+    stack_error_t (*save)(struct _stack_t* self, FILE* file);
+    stack_error_t (*load)(struct _stack_t* self, FILE* file, size_t count);
+
+    // Troncature (NULL = non supporte par stack_rollback, stack_clear retire les elements un par un)
+    // truncate retire les elements au-dessus des count premiers (count <= nombre d'elements)
+    void (*truncate)(struct _stack_t* self, size_t count);
+
+    // Parcours (NULL = non supporte pour at/foreach, implementation generique avec foreach pour find et contains)
+    // at retourne l'element a la profondeur depth (0 = sommet) ou NULL, foreach appelle visit jusqu'a ce qu'il
+    // retourne false, find retourne l'element egal a val le plus proche du sommet ou NULL
+    void* (*at)(struct _stack_t* self, size_t depth);
+    stack_error_t (*foreach)(struct _stack_t* self, stack_order_t order, stack_visitor_t visit, void* ctx);
+    void* (*find)(struct _stack_t* self, const void* val);
+    bool (*contains)(struct _stack_t* self, const void* val);
+
+    // Enregistrements de taille variable (NULL = non supporte, seulement STACK_TYPE_VARIABLE)
+    // emplace_record reserve un enregistrement de len octets, peek_record et pop_record_view donnent aussi sa longueur
+    void* (*emplace_record)(struct _stack_t* self, size_t len, stack_error_t* err);
+    void* (*peek_record)(struct _stack_t* self, size_t* len);
+    void* (*pop_record_view)(struct _stack_t* self, size_t* len);
+    stack_error_t (*push_records)(struct _stack_t* self, const void* data, const size_t* lens, size_t n);
+
+    // Attente (NULL = non supporte, seulement STACK_TYPE_CONCURRENT)
+    // pop_wait et push_wait attendent au plus timeout_ms millisecondes (STACK_WAIT_FOREVER = sans limite)
+    // qu'un element ou une place soit disponible, close reveille tous les threads en attente
+    stack_error_t (*pop_wait)(struct _stack_t* self, void* popped, long timeout_ms);
+    stack_error_t (*push_wait)(struct _stack_t* self, void* val, long timeout_ms);
+    void (*close)(struct _stack_t* self);
+
+    // Memoire (NULL = non supporte)
+    // shrink rend la memoire inutilisee au-dessus du sommet et retourne le nombre d'octets rendus
+    size_t (*shrink)(struct _stack_t* self);
+
+#ifdef STACK_STATS
+    stack_counters_t stats;
+#endif
 } stack_t;
 
 ///@brief Cree une pile generique
-///@param type: Le type de la pile (STACK_TYPE_FIXED ou STACK_TYPE_DYNAMIC)
-///@param config: La configuration de la pile (fstack_config_t ou dstack_config_t)
+///@param type: Le type de la pile (voir stack_type_t)
+///@param config: La configuration de la pile, selon le type :
+///       STACK_TYPE_FIXED: fstack_config_t
+///       STACK_TYPE_DYNAMIC: dstack_config_t
+///       STACK_TYPE_GROWABLE: gstack_config_t
+///       STACK_TYPE_CONCURRENT: cstack_config_t
+///       STACK_TYPE_WORK_STEALING: wstack_config_t
+///       STACK_TYPE_MAPPED: mstack_config_t
+///       STACK_TYPE_PERSISTENT: pstack_config_t
+///       STACK_TYPE_INDEXED: istack_config_t
+///       STACK_TYPE_VARIABLE: vstack_config_t
+///       STACK_TYPE_RESERVED: rstack_config_t
 ///@return Un pointeur vers la pile cree
 ///
 ///@error retourne NULL si la creation a echoue (print un message d'erreur)
 stack_t* stack_create(stack_type_t type, void* config);
 
+///@brief Cree une pile dans une zone memoire fournie par l'appelant (variable locale, memoire partagee, arena), sans allocation
+///@param buffer: La zone memoire (alignement quelconque : la pile commence a la premiere adresse alignee comme malloc)
+///@param bytes: La taille de buffer en octets, au moins stack_init_in_bytes(type, config)
+///@param type: Le type de la pile (seulement STACK_TYPE_FIXED)
+///@param config: La configuration de la pile (fstack_config_t, allocator est ignore)
+///@return Un pointeur vers la pile, a l'interieur de buffer
+///
+///@note stack_destroy libere les ressources de la pile (mlock) mais pas buffer, qui doit rester valide jusque-la
+///@error retourne NULL si buffer est trop petit, si la configuration est invalide ou si le type n'est pas supporte (print un message d'erreur)
+stack_t* stack_init_in(void* buffer, size_t bytes, stack_type_t type, void* config);
+
+///@brief Retourne la taille de la zone necessaire a stack_init_in pour cette configuration
+///@return Le nombre d'octets, 0 si le type n'est pas supporte ou si le tableau ne tient pas dans un size_t
+size_t stack_init_in_bytes(stack_type_t type, const void* config);
+
 ///@brief Detruit une pile generique
 ///@param stack_ptr: Un pointeur vers un pointeur de la pile a detruire
 ///@note le pointeur de la pile est mis a NULL
@@ -59,14 +479,16 @@ void stack_destroy(stack_t** stack_ptr);
 ///@brief Ajoute une copie de la valeur passe en parametre au sommet de la pile
 ///@param stack: La pile
 ///@param val: L'element a ajouter
-///@return 0 si l'ajout a reussi, -1 sinon
+///@return 0 si l'ajout a reussi, une autre valeur sinon (un stack_error_t)
 ///
-///@error retourne -1 si l'ajout a echoue (print un message d'erreur)
+///@error retourne une valeur non nulle si l'ajout a echoue (print un message d'erreur)
 int stack_push(stack_t* stack, void* val);
 
 ///@brief Retourne l'adresse de l'element au sommet de la pile
 ///@param stack: La pile
 ///@return Un pointeur vers l'element au sommet de la pile
+///
+///@note Pour une pile concurrente, l'element peut etre retire et reutilise par un autre thread a tout moment
 void* stack_peek(stack_t* stack);
 
 ///@brief Retire l'element au sommet de la pile et le copie dans popped
@@ -74,15 +496,315 @@ void* stack_peek(stack_t* stack);
 ///@param popped: L'enplacement ou stocker l'element retire (peut etre NULL)
 ///@return Un pointeur vers popped (donc NULL si popped est NULL)
 ///
-///@note NULL est retourne si la pile est vide
+///@note NULL est retourne si la pile est vide (sans message d'erreur)
 ///@note Si popped est NULL, l'element retire n'est pas copie et est libere
 ///@note Nous ne pouvons pas retourner l'adresse de l'element retire car il est libere
 ///@note Si popped est NULL, cela genere par defaut un warning (mettre WARN_STACK_POP_INTO_NULL a false pour le desactiver)
 void* stack_pop(stack_t* stack, void* popped);
 
+///@brief Reserve un nouvel element au sommet de la pile et retourne son adresse, sans copie
+///@param stack: La pile
+///@return Un pointeur vers l'element ajoute, a remplir par l'appelant
+///
+///@note Le contenu de l'element n'est pas initialise
+///@note Le pointeur reste valide jusqu'au prochain appel qui modifie la pile
+///@error retourne NULL si l'ajout a echoue (print un message d'erreur)
+void* stack_emplace(stack_t* stack);
+
+///@brief Retire l'element au sommet de la pile et retourne son adresse, sans copie
+///@param stack: La pile
+///@return Un pointeur vers l'element retire, NULL si la pile est vide
+///
+///@note Le pointeur reste valide jusqu'au prochain appel qui modifie la pile
+void* stack_pop_view(stack_t* stack);
+
+///@brief Vole l'element le plus ancien (au fond) d'une pile a vol de travail et le copie dans stolen
+///@param stack: La pile (STACK_TYPE_WORK_STEALING)
+///@param stolen: L'emplacement ou stocker l'element vole
+///@return Un pointeur vers stolen, NULL si la pile est vide ou si un autre thread a pris l'element en meme temps
+///
+///@note Peut etre appele par n'importe quel thread, en parallele du proprietaire de la pile
+void* stack_steal(stack_t* stack, void* stolen);
+
+///@brief Cree une nouvelle version independante d'une pile persistante, en O(1)
+///@param stack: La pile (STACK_TYPE_PERSISTENT)
+///@return La nouvelle pile, qui contient les memes elements (a detruire avec stack_destroy)
+///
+///@note Les deux piles partagent leurs noeuds : un push ou un pop sur l'une ne modifie pas l'autre
+///@error retourne NULL si le type de pile ne le supporte pas ou si l'allocation echoue (print un message d'erreur)
+stack_t* stack_fork(stack_t* stack);
+
+///@brief Fait une COPIE d'un enregistrement de len octets et l'ajoute au sommet d'une pile d'enregistrements
+///@param stack: La pile (STACK_TYPE_VARIABLE)
+///@param data: L'enregistrement (peut etre NULL si len vaut 0)
+///@param len: La taille de l'enregistrement en octets
+///@return STACK_OK, ou le code de l'erreur (print un message d'erreur)
+stack_error_t stack_push_record(stack_t* stack, const void* data, size_t len);
+
+///@brief Ajoute n enregistrements en une seule fois
+///@param stack: La pile (STACK_TYPE_VARIABLE)
+///@param data: Les enregistrements, les uns apres les autres (le premier finit au fond)
+///@param lens: La taille de chaque enregistrement
+///@param n: Le nombre d'enregistrements
+///@return STACK_OK, ou le code de l'erreur (print un message d'erreur), aucun enregistrement n'est ajoute en cas d'erreur
+stack_error_t stack_push_records(stack_t* stack, const void* data, const size_t* lens, size_t n);
+
+///@brief Reserve un enregistrement de len octets au sommet et retourne son adresse pour le remplir sur place
+///@param stack: La pile (STACK_TYPE_VARIABLE)
+///@param len: La taille de l'enregistrement en octets
+///@return Un pointeur vers l'enregistrement (non initialise), NULL si l'ajout a echoue (print un message d'erreur :
+///        STACK_ERR_FULL si len deborde de l'espace adressable, STACK_ERR_NO_MEMORY si la reservation echoue)
+///
+///@note Le pointeur reste valide jusqu'au prochain appel qui modifie la pile
+void* stack_emplace_record(stack_t* stack, size_t len);
+
+///@brief Retourne l'adresse et la longueur de l'enregistrement au sommet
+///@param stack: La pile (STACK_TYPE_VARIABLE)
+///@param len: Recoit la taille de l'enregistrement (peut etre NULL)
+///@return Un pointeur vers l'enregistrement, NULL si la pile est vide
+void* stack_peek_record(stack_t* stack, size_t* len);
+
+///@brief Retire l'enregistrement au sommet et le copie dans out
+///@param stack: La pile (STACK_TYPE_VARIABLE)
+///@param out: L'emplacement ou copier l'enregistrement (peut etre NULL)
+///@param capacity: La taille de out en octets
+///@param len: Recoit la taille de l'enregistrement (peut etre NULL)
+///@return STACK_OK, STACK_ERR_EMPTY, ou STACK_ERR_FULL si l'enregistrement depasse capacity (il reste alors dans la pile)
+///
+///@note N'ecrit jamais sur stderr : la taille de l'enregistrement est dans len meme en cas de STACK_ERR_FULL
+stack_error_t stack_pop_record(stack_t* stack, void* out, size_t capacity, size_t* len);
+
+///@brief Retire l'enregistrement au sommet et retourne son adresse, sans copie
+///@param stack: La pile (STACK_TYPE_VARIABLE)
+///@param len: Recoit la taille de l'enregistrement (peut etre NULL)
+///@return Un pointeur vers l'enregistrement retire, NULL si la pile est vide
+///
+///@note Le pointeur reste valide jusqu'au prochain appel qui modifie la pile
+void* stack_pop_record_view(stack_t* stack, size_t* len);
+
+///@brief Retire l'element au sommet, en attendant qu'un autre thread en ajoute un si la pile est vide
+///@param stack: La pile (STACK_TYPE_CONCURRENT)
+///@param popped: L'emplacement ou stocker l'element retire (peut etre NULL)
+///@param timeout_ms: Le temps d'attente maximal en millisecondes (0 = pas d'attente, STACK_WAIT_FOREVER = sans limite)
+///@return STACK_OK, STACK_ERR_EMPTY si la pile est toujours vide a l'echeance,
+///        ou STACK_ERR_CLOSED si la pile est fermee et vide
+///
+///@note Si un element est disponible, aucun appel systeme n'est fait ; sinon le thread s'endort (futex)
+///@note N'ecrit jamais sur stderr, sauf pour STACK_ERR_NULL et STACK_ERR_UNSUPPORTED
+stack_error_t stack_pop_wait(stack_t* stack, void* popped, long timeout_ms);
+
+///@brief Ajoute une COPIE d'un element, en attendant qu'un autre thread libere une place si la pile est pleine
+///@param stack: La pile (STACK_TYPE_CONCURRENT, bornee par cstack_config_t.max_length)
+///@param val: La valeur a ajouter
+///@param timeout_ms: Le temps d'attente maximal en millisecondes (0 = pas d'attente, STACK_WAIT_FOREVER = sans limite)
+///@return STACK_OK, STACK_ERR_FULL si la pile est toujours pleine a l'echeance, STACK_ERR_CLOSED si la pile est fermee,
+///        ou STACK_ERR_NO_MEMORY
+///
+///@note N'ecrit jamais sur stderr, sauf pour STACK_ERR_NULL et STACK_ERR_UNSUPPORTED
+stack_error_t stack_push_wait(stack_t* stack, void* val, long timeout_ms);
+
+///@brief Ferme une pile : les push suivants retournent STACK_ERR_CLOSED et tous les threads en attente sont reveilles
+///@param stack: La pile (STACK_TYPE_CONCURRENT)
+///
+///@note Les elements deja dans la pile peuvent toujours etre retires, stack_pop_wait ne retourne STACK_ERR_CLOSED
+///      qu'une fois la pile vide
+void stack_close(stack_t* stack);
+
+///@brief Rend au systeme (ou a l'allocateur) la memoire inutilisee au-dessus du sommet
+///@param stack: La pile
+///@return Le nombre d'octets rendus
+///
+///@note STACK_TYPE_FIXED garde son tableau mais rend ses pages au-dessus du sommet (madvise), STACK_TYPE_GROWABLE
+///      et STACK_TYPE_VARIABLE reduisent leur tableau (realloc), STACK_TYPE_DYNAMIC libere son bloc de reserve,
+///      STACK_TYPE_RESERVED libere ses pages au-dessus du sommet, STACK_TYPE_INDEXED reduit la pile qu'elle contient
+///@note Les pointeurs retournes par stack_peek, stack_emplace ou stack_pop_view peuvent devenir invalides
+///@error retourne 0 si le type de pile ne le supporte pas (print un message d'erreur)
+size_t stack_shrink_to_fit(stack_t* stack);
+
+///@brief Retourne le nombre d'elements de la pile
+///@param stack: La pile
+///
+///@note Non supporte par STACK_TYPE_CONCURRENT et STACK_TYPE_WORK_STEALING (retourne 0, print un message d'erreur)
+size_t stack_size(stack_t* stack);
+
+///@brief Retourne l'element a la profondeur depth, sans le retirer
+///@param stack: La pile
+///@param depth: La profondeur de l'element (0 = le sommet, comme stack_peek)
+///@return Un pointeur vers l'element, NULL si la pile contient depth elements ou moins
+///
+///@note O(1) pour les piles a tableau, O(depth / chunk_length) pour STACK_TYPE_DYNAMIC et O(depth) pour STACK_TYPE_PERSISTENT
+///@note Non supporte par STACK_TYPE_CONCURRENT et STACK_TYPE_WORK_STEALING (print un message d'erreur)
+void* stack_at(stack_t* stack, size_t depth);
+
+///@brief Appelle visit sur chaque element de la pile, sans les retirer
+///@param stack: La pile
+///@param order: STACK_ORDER_TOP_DOWN (du sommet vers le fond) ou STACK_ORDER_BOTTOM_UP
+///@param visit: La fonction a appeler, le parcours s'arrete quand elle retourne false
+///@param ctx: Un contexte utilisateur passe a visit
+///@return STACK_OK, ou le code de l'erreur (print un message d'erreur)
+///
+///@note visit peut lire la pile mais ne doit pas la modifier pendant le parcours
+///@note Non supporte par STACK_TYPE_CONCURRENT et STACK_TYPE_WORK_STEALING (STACK_ERR_UNSUPPORTED)
+stack_error_t stack_foreach(stack_t* stack, stack_order_t order, stack_visitor_t visit, void* ctx);
+
+///@brief Cherche un element egal a val (compare octet par octet, comme memcmp)
+///@param stack: La pile
+///@param val: L'element a chercher (size octets)
+///@return Un pointeur vers l'element trouve le plus proche du sommet, NULL s'il n'y en a pas
+///
+///@note Les elements de 4 et 8 octets des tableaux contigus sont compares par groupes de 16 octets (SSE2)
+///@note Les octets de padding d'une structure sont compares aussi : ils doivent etre initialises
+///@note Non supporte par STACK_TYPE_CONCURRENT et STACK_TYPE_WORK_STEALING (print un message d'erreur)
+void* stack_find(stack_t* stack, const void* val);
+
+///@brief Indique si la pile contient un element egal a val (compare octet par octet, comme memcmp)
+///@param stack: La pile
+///@param val: L'element a chercher (size octets)
+///
+///@note O(1) pour STACK_TYPE_INDEXED, sinon equivalent a stack_find(stack, val) != NULL
+bool stack_contains(stack_t* stack, const void* val);
+
+///@brief Retourne un point de reprise : la profondeur actuelle de la pile
+///@param stack: La pile
+///@return Le point de reprise, a passer a stack_rollback
+///
+///@note Non supporte par STACK_TYPE_CONCURRENT et STACK_TYPE_WORK_STEALING (retourne 0, print un message d'erreur)
+stack_mark_t stack_mark(stack_t* stack);
+
+///@brief Retire d'un coup tous les elements ajoutes depuis stack_mark, sans les copier
+///@param stack: La pile
+///@param mark: Un point de reprise retourne par stack_mark sur cette pile
+///@return STACK_OK, ou le code de l'erreur (print un message d'erreur)
+///
+///@note Les piles a tableau reculent seulement leur sommet, STACK_TYPE_DYNAMIC libere ses blocs entiers
+///@error STACK_ERR_RANGE si la pile contient moins d'elements que mark (elle n'est pas modifiee)
+stack_error_t stack_rollback(stack_t* stack, stack_mark_t mark);
+
+///@brief Retire tous les elements de la pile
+///@param stack: La pile
+///
+///@note Les piles sans truncate (STACK_TYPE_CONCURRENT, STACK_TYPE_WORK_STEALING) sont videes element par element
+///@note Pour STACK_TYPE_WORK_STEALING, seul le thread proprietaire peut vider la pile
+void stack_clear(stack_t* stack);
+
+///@brief Ecrit un snapshot de la pile dans file : un en-tete versionne (type, size, nombre d'elements)
+///       suivi des elements bruts, du fond vers le sommet
+///@param stack: La pile (elle n'est pas modifiee)
+///@param file: Un fichier ouvert en ecriture binaire
+///@return STACK_OK, ou le code de l'erreur (print un message d'erreur)
+///
+///@note Les entiers de l'en-tete et les elements sont ecrits dans l'ordre des octets de la machine
+///@note Non supporte par STACK_TYPE_CONCURRENT et STACK_TYPE_WORK_STEALING (STACK_ERR_UNSUPPORTED)
+stack_error_t stack_save(stack_t* stack, FILE* file);
+
+///@brief Lit un snapshot ecrit par stack_save et ajoute ses elements au sommet de la pile
+///@param stack: La pile (de n'importe quel type, avec la meme taille d'element que le snapshot)
+///@param file: Un fichier ouvert en lecture binaire, positionne au debut du snapshot
+///@return STACK_OK, ou le code de l'erreur (print un message d'erreur)
+///
+///@note Les elements sont lus directement dans le stockage de la pile quand il est contigu
+///@error En cas d'erreur de lecture, les elements deja lus peuvent rester dans la pile
+stack_error_t stack_load(stack_t* stack, FILE* file);
+
+#ifdef STACK_STATS
+///@brief Retourne les statistiques d'une pile (disponible seulement avec -DSTACK_STATS)
+///@param stack: La pile
+///
+///@note La bibliotheque et le programme doivent etre compiles tous les deux avec ou sans STACK_STATS
+///@note Pour les piles partagees entre threads, les compteurs sont lus un par un (pas de snapshot coherent)
+stack_stats_t stack_get_stats(stack_t* stack);
+#endif
+
+///@brief Installe une fonction appelee a chaque erreur d'une operation sur une pile
+///@param handler: La fonction a appeler (NULL = aucune)
+///@param ctx: Un contexte utilisateur passe a handler
+///
+///@note Les fonctions stack_try_* n'ecrivent jamais sur stderr : elles retournent l'erreur et appellent handler
+///@note Si un handler est installe, les autres fonctions l'appellent au lieu d'ecrire leurs erreurs sur stderr
+///@note A appeler a l'initialisation du programme (la fonction n'est pas thread-safe)
+void stack_set_error_handler(stack_error_handler_t handler, void* ctx);
+
+///@brief Retourne une description d'un code d'erreur
+const char* stack_strerror(stack_error_t err);
+
+///@brief Version verifiee de stack_push, sans entree/sortie
+///@return STACK_OK, STACK_ERR_NULL, STACK_ERR_FULL ou STACK_ERR_NO_MEMORY
+stack_error_t stack_try_push(stack_t* stack, void* val);
+
+///@brief Version verifiee de stack_pop, sans entree/sortie
+///@param popped: L'enplacement ou stocker l'element retire (peut etre NULL, sans warning)
+///@return STACK_OK, STACK_ERR_NULL ou STACK_ERR_EMPTY
+stack_error_t stack_try_pop(stack_t* stack, void* popped);
+
+///@brief Version verifiee de stack_peek, sans entree/sortie
+///@param top: Recoit l'adresse de l'element au sommet
+///@return STACK_OK, STACK_ERR_NULL ou STACK_ERR_EMPTY
+stack_error_t stack_try_peek(stack_t* stack, void** top);
+
+///@brief Version verifiee de stack_push_n, sans entree/sortie
+///@return STACK_OK, STACK_ERR_NULL, STACK_ERR_FULL ou STACK_ERR_NO_MEMORY
+stack_error_t stack_try_push_n(stack_t* stack, const void* vals, size_t n);
+
+// Version non verifiee des operations : appel direct de la vtable, sans test de NULL ni message.
+// Les arguments ne sont verifies que par des assert, qui disparaissent avec NDEBUG.
+
+static inline stack_error_t stack_push_unsafe(stack_t* stack, void* val){
+    assert(stack && val);
+    return stack->push(stack, val);
+}
+
+static inline stack_error_t stack_pop_unsafe(stack_t* stack, void* popped){
+    assert(stack);
+    return stack->pop(stack, popped);
+}
+
+static inline void* stack_peek_unsafe(stack_t* stack){
+    assert(stack);
+    return stack->peek(stack);
+}
+
+static inline bool stack_is_empty_unsafe(stack_t* stack){
+    assert(stack);
+    return stack->is_empty(stack);
+}
+
+///@brief Cree un pool de blocs de taille fixe
+///@param block_size: La taille d'un bloc (0 = la taille de la premiere allocation demandee)
+///@param blocks_per_slab: Le nombre de blocs alloues d'un coup lorsque le pool est vide (0 = 64)
+///@param allocator: L'allocateur utilise pour les tranches de blocs (NULL = malloc/free)
+///@return Un pointeur vers le pool cree
+///
+///@note Le pool n'est pas thread-safe
+///@error retourne NULL si la creation a echoue (print un message d'erreur)
+stack_pool_t* stack_pool_create(size_t block_size, size_t blocks_per_slab, const stack_allocator_t* allocator);
+
+///@brief Detruit un pool et libere toute sa memoire
+///@param pool_ptr: Un pointeur vers un pointeur du pool a detruire
+///@note le pointeur du pool est mis a NULL
+void stack_pool_destroy(stack_pool_t** pool_ptr);
+
 ///@brief Verifie si la pile est vide
 ///@param stack: La pile
 ///@return true si la pile est vide, false sinon
 bool stack_is_empty(stack_t* stack);
 
+///@brief Ajoute une copie de n elements contigus au sommet de la pile
+///@param stack: La pile
+///@param vals: Les elements a ajouter, vals[n-1] se retrouve au sommet
+///@param n: Le nombre d'elements
+///@return 0 si l'ajout a reussi, une autre valeur sinon
+///
+///@note Pour une pile de taille fixe, rien n'est ajoute s'il n'y a pas la place pour les n elements
+///@error retourne une valeur non nulle si l'ajout a echoue (print un message d'erreur)
+int stack_push_n(stack_t* stack, const void* vals, size_t n);
+
+///@brief Retire jusqu'a n elements du sommet de la pile et les copie dans out
+///@param stack: La pile
+///@param out: Un tableau d'au moins n elements (peut etre NULL pour simplement retirer les elements)
+///@param n: Le nombre maximal d'elements a retirer
+///@param order: STACK_ORDER_TOP_DOWN: out[0] est l'ancien sommet (ordre LIFO)
+///              STACK_ORDER_BOTTOM_UP: out garde l'ordre d'ajout, out[k-1] est l'ancien sommet
+///@return Le nombre k d'elements retires (inferieur a n si la pile contenait moins de n elements)
+size_t stack_pop_n(stack_t* stack, void* out, size_t n, stack_order_t order);
+
 #endif // __STACK_H__
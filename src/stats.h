@@ -0,0 +1,88 @@
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#include "stack.h"
+
+// Compteurs des piles (voir stack_get_stats), compiles seulement avec -DSTACK_STATS :
+// sans STACK_STATS toutes les macros sont vides et stack_t n'a pas de champ stats.
+//
+// Les compteurs sont des atomiques relaxed. Pour les piles d'un seul thread, une incrementation est
+// un load + store (pas d'instruction lock), seules les piles partagees entre threads utilisent fetch_add.
+
+#ifdef STACK_STATS
+
+#include <stdatomic.h>
+
+static inline bool stack_stats_shared(const stack_t* stack){
+    return stack->type == STACK_TYPE_CONCURRENT || stack->type == STACK_TYPE_WORK_STEALING;
+}
+
+//Ajoute n au compteur et retourne sa nouvelle valeur
+static inline size_t stack_stats_add(const stack_t* stack, _Atomic size_t* counter, size_t n){
+    if (stack_stats_shared(stack))
+        return atomic_fetch_add_explicit(counter, n, memory_order_relaxed) + n;
+
+    size_t value = atomic_load_explicit(counter, memory_order_relaxed) + n;
+    atomic_store_explicit(counter, value, memory_order_relaxed);
+    return value;
+}
+
+static inline void stack_stats_sub(const stack_t* stack, _Atomic size_t* counter, size_t n){
+    if (stack_stats_shared(stack)) atomic_fetch_sub_explicit(counter, n, memory_order_relaxed);
+    else atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) - n, memory_order_relaxed);
+}
+
+static inline void stack_stats_high_water(stack_t* stack, size_t depth){
+    size_t high = atomic_load_explicit(&stack->stats.high_water, memory_order_relaxed);
+    while (depth > high){
+        if (!stack_stats_shared(stack)){
+            atomic_store_explicit(&stack->stats.high_water, depth, memory_order_relaxed);
+            return;
+        }
+        if (atomic_compare_exchange_weak_explicit(&stack->stats.high_water, &high, depth, memory_order_relaxed, memory_order_relaxed))
+            return;
+    }
+}
+
+static inline void stack_stats_push(stack_t* stack, size_t n){
+    stack_stats_add(stack, &stack->stats.pushes, n);
+    stack_stats_high_water(stack, stack_stats_add(stack, &stack->stats.depth, n));
+}
+
+static inline void stack_stats_pop(stack_t* stack, size_t n){
+    stack_stats_add(stack, &stack->stats.pops, n);
+    stack_stats_sub(stack, &stack->stats.depth, n);
+}
+
+//Une allocation (ou une liberation si bytes est negatif) de l'allocateur, du pool ou d'une projection
+static inline void stack_stats_alloc(stack_t* stack, ptrdiff_t bytes){
+    stack_stats_add(stack, &stack->stats.allocator_calls, 1);
+    if (bytes >= 0) stack_stats_add(stack, &stack->stats.bytes_allocated, (size_t)bytes);
+    else stack_stats_sub(stack, &stack->stats.bytes_allocated, (size_t)-bytes);
+}
+
+#define STACK_STATS_PUSH(stack, n) stack_stats_push((stack_t*)(stack), (n))
+#define STACK_STATS_POP(stack, n) stack_stats_pop((stack_t*)(stack), (n))
+#define STACK_STATS_PUSH_FAILED(stack) ((void)stack_stats_add((stack_t*)(stack), &((stack_t*)(stack))->stats.failed_pushes, 1))
+#define STACK_STATS_ALLOC(stack, bytes) stack_stats_alloc((stack_t*)(stack), (ptrdiff_t)(bytes))
+#define STACK_STATS_FREE(stack, bytes) stack_stats_alloc((stack_t*)(stack), -(ptrdiff_t)(bytes))
+#define STACK_STATS_TRIM(stack, bytes) ((void)stack_stats_add((stack_t*)(stack), &((stack_t*)(stack))->stats.bytes_trimmed, (bytes)))
+#define STACK_STATS_SET_DEPTH(stack, n)                                                             \
+    do {                                                                                            \
+        atomic_store_explicit(&((stack_t*)(stack))->stats.depth, (n), memory_order_relaxed);        \
+        atomic_store_explicit(&((stack_t*)(stack))->stats.high_water, (n), memory_order_relaxed);   \
+    } while (0)
+
+#else
+
+#define STACK_STATS_PUSH(stack, n) ((void)0)
+#define STACK_STATS_POP(stack, n) ((void)0)
+#define STACK_STATS_PUSH_FAILED(stack) ((void)0)
+#define STACK_STATS_ALLOC(stack, bytes) ((void)0)
+#define STACK_STATS_FREE(stack, bytes) ((void)0)
+#define STACK_STATS_TRIM(stack, bytes) ((void)0)
+#define STACK_STATS_SET_DEPTH(stack, n) ((void)0)
+
+#endif // STACK_STATS
+
+#endif // __STATS_H__
@@ -1,12 +1,23 @@
 #include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "stack.h"
+#include "tstack.h"
+#include "fstack.h"
+#include "gstack.h"
+#include "cstack.h"
+#include "rstack.h"
+
+STACK_DEFINE(size_stack, size_t)
 
 typedef struct _test_result {
     bool passed;
@@ -216,6 +227,1488 @@ test_result t_stack_dynamic_resize() {
     return (test_result){.passed = passed, .name = "Test stack_dynamic_resize"};
 }
 
+test_result t_stack_dynamic_chunk_boundary() {
+    bool passed = true;
+
+    dstack_config_t config = {
+        .size = sizeof(int),
+        .chunk_length = 3
+    };
+    stack_t *stack = stack_create(STACK_TYPE_DYNAMIC, &config);
+
+    // On fait plusieurs allers-retours autour des frontieres de blocs
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 10; i++) {
+            if (stack_push(stack, &i) != 0) passed = false;
+            if (*(int *)stack_peek(stack) != i) passed = false;
+        }
+
+        for (int i = 9; i >= 0; i--) {
+            int value_popped;
+            if (!stack_pop(stack, &value_popped)) passed = false;
+            if (value_popped != i) passed = false;
+        }
+
+        if (!stack_is_empty(stack)) passed = false;
+    }
+
+    stack_destroy(&stack);
+    return (test_result){.passed = passed, .name = "Test stack_dynamic_chunk_boundary"};
+}
+
+test_result t_stack_growable_push_pop() {
+    bool passed = true;
+
+    gstack_config_t config = {
+        .size = sizeof(int),
+        .initial_length = 2
+    };
+    stack_t *stack = stack_create(STACK_TYPE_GROWABLE, &config);
+    if (!stack) return (test_result){.passed = false, .name = "Test stack_growable_push_pop"};
+
+    // La pile doit s'agrandir plusieurs fois
+    for (int i = 0; i < 100; i++) {
+        if (stack_push(stack, &i) != 0) passed = false;
+        if (*(int *)stack_peek(stack) != i) passed = false;
+    }
+
+    for (int i = 99; i >= 0; i--) {
+        int value_popped;
+        if (!stack_pop(stack, &value_popped)) passed = false;
+        if (value_popped != i) passed = false;
+    }
+
+    if (!stack_is_empty(stack)) passed = false;
+
+    stack_destroy(&stack);
+    return (test_result){.passed = passed, .name = "Test stack_growable_push_pop"};
+}
+
+test_result t_stack_growable_max_length() {
+    bool passed = true;
+
+    gstack_config_t config = {
+        .size = sizeof(int),
+        .initial_length = 1,
+        .max_length = 3,
+        .growth_factor = 1.5
+    };
+    stack_t *stack = stack_create(STACK_TYPE_GROWABLE, &config);
+
+    int value1 = 1, value2 = 2, value3 = 3, value4 = 4;
+    if (stack_push(stack, &value1) != 0) passed = false;
+    if (stack_push(stack, &value2) != 0) passed = false;
+    if (stack_push(stack, &value3) != 0) passed = false;
+
+    if (stack_push(stack, &value4) == 0) passed = false;  // Cela ne doit pas réussir.
+    if (*(int *)stack_peek(stack) != 3) passed = false;
+
+    stack_destroy(&stack);
+    return (test_result){.passed = passed, .name = "Test stack_growable_max_length"};
+}
+
+typedef struct {
+    size_t allocs;
+    size_t frees;
+} counting_allocator_ctx;
+
+static void *counting_alloc(void *ctx, size_t bytes) {
+    ((counting_allocator_ctx *)ctx)->allocs++;
+    return malloc(bytes);
+}
+
+static void *counting_realloc(void *ctx, void *ptr, size_t bytes) {
+    (void)ctx;
+    return realloc(ptr, bytes);
+}
+
+static void counting_free(void *ctx, void *ptr) {
+    ((counting_allocator_ctx *)ctx)->frees++;
+    free(ptr);
+}
+
+test_result t_stack_custom_allocator() {
+    bool passed = true;
+
+    counting_allocator_ctx ctx = {0};
+    stack_allocator_t allocator = {
+        .alloc = counting_alloc,
+        .realloc = counting_realloc,
+        .free = counting_free,
+        .ctx = &ctx
+    };
+
+    stack_t *stacks[] = {
+        stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.length = 10, .size = sizeof(int), .allocator = &allocator}),
+        stack_create(STACK_TYPE_DYNAMIC, &(dstack_config_t){.size = sizeof(int), .chunk_length = 4, .allocator = &allocator}),
+        stack_create(STACK_TYPE_GROWABLE, &(gstack_config_t){.size = sizeof(int), .initial_length = 2, .allocator = &allocator})
+    };
+
+    for (size_t s = 0; s < sizeof(stacks) / sizeof(stacks[0]); s++) {
+        if (!stacks[s]) { passed = false; continue; }
+
+        for (int i = 0; i < 10; i++) {
+            if (stack_push(stacks[s], &i) != 0) passed = false;
+        }
+
+        int value_popped;
+        if (!stack_pop(stacks[s], &value_popped) || value_popped != 9) passed = false;
+
+        stack_destroy(&stacks[s]);
+    }
+
+    // Toute la memoire doit passer par l'allocateur et etre rendue
+    if (ctx.allocs == 0) passed = false;
+    if (ctx.allocs != ctx.frees) passed = false;
+
+    return (test_result){.passed = passed, .name = "Test stack_custom_allocator"};
+}
+
+test_result t_stack_dynamic_pool() {
+    bool passed = true;
+
+    counting_allocator_ctx ctx = {0};
+    stack_allocator_t allocator = {
+        .alloc = counting_alloc,
+        .realloc = counting_realloc,
+        .free = counting_free,
+        .ctx = &ctx
+    };
+
+    stack_pool_t *pool = stack_pool_create(0, 8, &allocator);
+    if (!pool) return (test_result){.passed = false, .name = "Test stack_dynamic_pool"};
+
+    dstack_config_t config = {
+        .size = sizeof(int),
+        .chunk_length = 2,
+        .pool = pool
+    };
+
+    // Les blocs rendus par une pile sont recycles par la suivante
+    for (int round = 0; round < 4; round++) {
+        stack_t *stack = stack_create(STACK_TYPE_DYNAMIC, &config);
+        if (!stack) { passed = false; break; }
+
+        for (int i = 0; i < 10; i++) {
+            if (stack_push(stack, &i) != 0) passed = false;
+        }
+
+        for (int i = 9; i >= 0; i--) {
+            int value_popped;
+            if (!stack_pop(stack, &value_popped) || value_popped != i) passed = false;
+        }
+
+        stack_destroy(&stack);
+    }
+
+    // Une seule tranche de 8 blocs suffit pour 5 blocs de 2 elements
+    if (ctx.allocs != 2) passed = false;  // le pool + une tranche
+
+    stack_pool_destroy(&pool);
+    if (pool) passed = false;
+    if (ctx.allocs != ctx.frees) passed = false;
+
+    return (test_result){.passed = passed, .name = "Test stack_dynamic_pool"};
+}
+
+test_result t_stack_push_pop_n() {
+    bool passed = true;
+
+    stack_t *stacks[] = {
+        stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.length = 100, .size = sizeof(int)}),
+        stack_create(STACK_TYPE_DYNAMIC, &(dstack_config_t){.size = sizeof(int), .chunk_length = 7}),
+        stack_create(STACK_TYPE_GROWABLE, &(gstack_config_t){.size = sizeof(int), .initial_length = 4})
+    };
+
+    int values[50];
+    for (int i = 0; i < 50; i++) values[i] = i;
+
+    for (size_t s = 0; s < sizeof(stacks) / sizeof(stacks[0]); s++) {
+        stack_t *stack = stacks[s];
+
+        if (stack_push_n(stack, values, 50) != 0) passed = false;
+        if (*(int *)stack_peek(stack) != 49) passed = false;
+
+        // LIFO : out[0] est l'ancien sommet
+        int out[50];
+        if (stack_pop_n(stack, out, 20, STACK_ORDER_TOP_DOWN) != 20) passed = false;
+        for (int i = 0; i < 20; i++) {
+            if (out[i] != 49 - i) passed = false;
+        }
+
+        // ordre d'ajout conserve, on demande plus que ce que la pile contient
+        if (stack_pop_n(stack, out, 50, STACK_ORDER_BOTTOM_UP) != 30) passed = false;
+        for (int i = 0; i < 30; i++) {
+            if (out[i] != i) passed = false;
+        }
+
+        if (!stack_is_empty(stack)) passed = false;
+
+        // melange push unitaire et push_n
+        int value = 100;
+        stack_push(stack, &value);
+        if (stack_push_n(stack, values, 10) != 0) passed = false;
+        if (stack_pop_n(stack, NULL, 10, STACK_ORDER_TOP_DOWN) != 10) passed = false;
+        if (*(int *)stack_peek(stack) != 100) passed = false;
+
+        stack_destroy(&stacks[s]);
+    }
+
+    return (test_result){.passed = passed, .name = "Test stack_push_pop_n"};
+}
+
+test_result t_stack_fixed_push_n_overflow() {
+    bool passed = true;
+
+    fstack_config_t config = {
+        .length = 5,
+        .size = sizeof(int)
+    };
+    stack_t *stack = stack_create(STACK_TYPE_FIXED, &config);
+
+    int values[6] = {1, 2, 3, 4, 5, 6};
+    if (stack_push_n(stack, values, 6) == 0) passed = false;  // Cela ne doit pas réussir.
+    if (!stack_is_empty(stack)) passed = false;               // et rien ne doit etre ajoute.
+
+    if (stack_push_n(stack, values, 5) != 0) passed = false;
+
+    stack_destroy(&stack);
+    return (test_result){.passed = passed, .name = "Test stack_fixed_push_n_overflow"};
+}
+
+test_result t_stack_emplace_pop_view() {
+    bool passed = true;
+
+    typedef struct {
+        size_t id;
+        char name[20];
+    } record_t;
+
+    stack_t *stacks[] = {
+        stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.length = 10, .size = sizeof(record_t)}),
+        stack_create(STACK_TYPE_DYNAMIC, &(dstack_config_t){.size = sizeof(record_t), .chunk_length = 2}),
+        stack_create(STACK_TYPE_GROWABLE, &(gstack_config_t){.size = sizeof(record_t), .initial_length = 1})
+    };
+
+    for (size_t s = 0; s < sizeof(stacks) / sizeof(stacks[0]); s++) {
+        stack_t *stack = stacks[s];
+
+        for (size_t i = 0; i < 5; i++) {
+            record_t *r = stack_emplace(stack);
+            if (!r) { passed = false; break; }
+            r->id = i;
+            snprintf(r->name, sizeof(r->name), "user %zu", i);
+        }
+
+        if (((record_t *)stack_peek(stack))->id != 4) passed = false;
+
+        for (size_t i = 5; i-- > 0;) {
+            record_t *r = stack_pop_view(stack);
+            if (!r || r->id != i) passed = false;
+            char expected[32];
+            snprintf(expected, sizeof(expected), "user %zu", i);
+            if (r && strcmp(r->name, expected) != 0) passed = false;
+        }
+
+        if (stack_pop_view(stack) != NULL) passed = false;
+        if (!stack_is_empty(stack)) passed = false;
+
+        stack_destroy(&stacks[s]);
+    }
+
+    return (test_result){.passed = passed, .name = "Test stack_emplace_pop_view"};
+}
+
+test_result t_stack_concurrent_push_pop() {
+    bool passed = true;
+
+    cstack_config_t config = {
+        .size = sizeof(int),
+        .initial_length = 2
+    };
+    stack_t *stack = stack_create(STACK_TYPE_CONCURRENT, &config);
+    if (!stack) return (test_result){.passed = false, .name = "Test stack_concurrent_push_pop"};
+
+    if (!stack_is_empty(stack)) passed = false;
+
+    // Plusieurs segments de noeuds sont alloues
+    for (int i = 0; i < 100; i++) {
+        if (stack_push(stack, &i) != 0) passed = false;
+        if (*(int *)stack_peek(stack) != i) passed = false;
+    }
+
+    for (int i = 99; i >= 0; i--) {
+        int value_popped;
+        if (!stack_pop(stack, &value_popped)) passed = false;
+        if (value_popped != i) passed = false;
+    }
+
+    if (!stack_is_empty(stack)) passed = false;
+
+    stack_destroy(&stack);
+    return (test_result){.passed = passed, .name = "Test stack_concurrent_push_pop"};
+}
+
+#define CONCURRENT_THREADS 4
+#define CONCURRENT_VALUES 20000
+
+typedef struct {
+    stack_t *stack;
+    size_t first;
+    size_t popped_sum;
+    size_t popped_count;
+} concurrent_worker_t;
+
+static void *concurrent_worker(void *arg) {
+    concurrent_worker_t *w = arg;
+
+    for (size_t i = 0; i < CONCURRENT_VALUES; i++) {
+        size_t value = w->first + i;
+        stack_push(w->stack, &value);
+
+        // un pop sur deux, pour melanger les operations des threads
+        if (i % 2) {
+            size_t value_popped;
+            if (stack_pop(w->stack, &value_popped)) {
+                w->popped_sum += value_popped;
+                w->popped_count++;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static bool run_concurrent_threads(cstack_config_t config) {
+    bool passed = true;
+
+    stack_t *stack = stack_create(STACK_TYPE_CONCURRENT, &config);
+    if (!stack) return false;
+
+    pthread_t threads[CONCURRENT_THREADS];
+    concurrent_worker_t workers[CONCURRENT_THREADS];
+
+    for (size_t t = 0; t < CONCURRENT_THREADS; t++) {
+        workers[t] = (concurrent_worker_t){.stack = stack, .first = t * CONCURRENT_VALUES};
+        pthread_create(&threads[t], NULL, concurrent_worker, &workers[t]);
+    }
+
+    size_t sum = 0, count = 0;
+    for (size_t t = 0; t < CONCURRENT_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        sum += workers[t].popped_sum;
+        count += workers[t].popped_count;
+    }
+
+    size_t value_popped;
+    while (stack_pop(stack, &value_popped)) {
+        sum += value_popped;
+        count++;
+    }
+
+    // Chaque valeur doit etre retiree exactement une fois
+    size_t n = CONCURRENT_THREADS * CONCURRENT_VALUES;
+    if (count != n) passed = false;
+    if (sum != n * (n - 1) / 2) passed = false;
+
+#ifdef STACK_STATS
+    stack_stats_t stats = stack_get_stats(stack);
+    if (stats.pushes != n || stats.pops != n || stats.depth != 0 || stats.high_water == 0) passed = false;
+#endif
+
+    stack_destroy(&stack);
+    return passed;
+}
+
+test_result t_stack_concurrent_threads() {
+    bool passed = run_concurrent_threads((cstack_config_t){.size = sizeof(size_t)});
+    return (test_result){.passed = passed, .name = "Test stack_concurrent_threads"};
+}
+
+test_result t_stack_concurrent_elimination() {
+    bool passed = true;
+
+    if (!run_concurrent_threads((cstack_config_t){
+        .size = sizeof(size_t),
+        .elimination_slots = 4
+    })) passed = false;
+
+    if (!run_concurrent_threads((cstack_config_t){
+        .size = sizeof(size_t),
+        .elimination_slots = 8,
+        .elimination_adaptive = true,
+        .elimination_spins = 16
+    })) passed = false;
+
+    //top et les cases d'elimination sont chacun seuls sur leur ligne de cache
+    cstack_t *cstack = (cstack_t*)stack_create(STACK_TYPE_CONCURRENT, &(cstack_config_t){.size = sizeof(size_t), .elimination_slots = 3});
+    if (!cstack) passed = false;
+    else{
+        if ((uintptr_t)&cstack->top % CSTACK_CACHE_LINE || (uintptr_t)cstack->slots % CSTACK_CACHE_LINE) passed = false;
+        if (offsetof(cstack_t, free_list) - offsetof(cstack_t, top) < CSTACK_CACHE_LINE) passed = false;
+        stack_destroy((stack_t**)&cstack);
+    }
+
+    //un tableau d'elimination dont la taille deborde est refuse
+    if (stack_create(STACK_TYPE_CONCURRENT, &(cstack_config_t){.size = sizeof(size_t), .elimination_slots = SIZE_MAX / 2})) passed = false;
+
+    return (test_result){.passed = passed, .name = "Test stack_concurrent_elimination"};
+}
+
+#define WAIT_CONSUMERS 3
+#define WAIT_VALUES 20000
+
+typedef struct {
+    stack_t *stack;
+    size_t popped_sum;
+    size_t popped_count;
+} wait_consumer_t;
+
+static void *wait_consumer(void *arg) {
+    wait_consumer_t *c = arg;
+    size_t value;
+
+    // attend les elements jusqu'a la fermeture de la pile
+    while (stack_pop_wait(c->stack, &value, STACK_WAIT_FOREVER) == STACK_OK) {
+        c->popped_sum += value;
+        c->popped_count++;
+    }
+
+    return NULL;
+}
+
+test_result t_stack_concurrent_wait() {
+    bool passed = true;
+
+    stack_t *stack = stack_create(STACK_TYPE_CONCURRENT, &(cstack_config_t){.size = sizeof(size_t), .max_length = 2});
+    if (!stack) return (test_result){.passed = false, .name = "Test stack_concurrent_wait"};
+
+    // Pile vide ou pleine : les attentes expirent
+    size_t value = 1;
+    if (stack_pop_wait(stack, &value, 0) != STACK_ERR_EMPTY) passed = false;
+    if (stack_pop_wait(stack, &value, 5) != STACK_ERR_EMPTY) passed = false;
+
+    if (stack_push_wait(stack, &value, 0) != STACK_OK) passed = false;
+    if (stack_try_push(stack, &value) != STACK_OK) passed = false;
+    if (stack_try_push(stack, &value) != STACK_ERR_FULL) passed = false;
+    if (stack_push_wait(stack, &value, 5) != STACK_ERR_FULL) passed = false;
+
+    if (stack_pop_wait(stack, &value, 5) != STACK_OK || value != 1) passed = false;
+    if (stack_push_wait(stack, &value, 5) != STACK_OK) passed = false;
+    while (stack_try_pop(stack, NULL) == STACK_OK);
+
+    // Un producteur, plusieurs consommateurs endormis : la pile bornee force le producteur a attendre aussi
+    pthread_t threads[WAIT_CONSUMERS];
+    wait_consumer_t consumers[WAIT_CONSUMERS];
+
+    for (size_t t = 0; t < WAIT_CONSUMERS; t++) {
+        consumers[t] = (wait_consumer_t){.stack = stack};
+        pthread_create(&threads[t], NULL, wait_consumer, &consumers[t]);
+    }
+
+    for (size_t i = 0; i < WAIT_VALUES; i++) {
+        if (stack_push_wait(stack, &i, STACK_WAIT_FOREVER) != STACK_OK) passed = false;
+    }
+
+    // Les consommateurs vident la pile avant de voir la fermeture
+    stack_close(stack);
+
+    size_t sum = 0, count = 0;
+    for (size_t t = 0; t < WAIT_CONSUMERS; t++) {
+        pthread_join(threads[t], NULL);
+        sum += consumers[t].popped_sum;
+        count += consumers[t].popped_count;
+    }
+
+    if (count != WAIT_VALUES || sum != (size_t)WAIT_VALUES * (WAIT_VALUES - 1) / 2) passed = false;
+
+    if (stack_try_push(stack, &value) != STACK_ERR_CLOSED) passed = false;
+    if (stack_push_wait(stack, &value, STACK_WAIT_FOREVER) != STACK_ERR_CLOSED) passed = false;
+    if (stack_pop_wait(stack, &value, STACK_WAIT_FOREVER) != STACK_ERR_CLOSED) passed = false;
+
+    stack_destroy(&stack);
+    return (test_result){.passed = passed, .name = "Test stack_concurrent_wait"};
+}
+
+test_result t_stack_work_stealing_push_pop_steal() {
+    bool passed = true;
+
+    wstack_config_t config = {
+        .size = sizeof(int),
+        .initial_length = 2
+    };
+    stack_t *stack = stack_create(STACK_TYPE_WORK_STEALING, &config);
+    if (!stack) return (test_result){.passed = false, .name = "Test stack_work_stealing_push_pop_steal"};
+
+    // Le tableau doit s'agrandir plusieurs fois
+    for (int i = 0; i < 20; i++) {
+        if (stack_push(stack, &i) != 0) passed = false;
+    }
+
+    // Le proprietaire retire le sommet, les voleurs prennent le fond
+    int value;
+    if (!stack_pop(stack, &value) || value != 19) passed = false;
+    if (!stack_steal(stack, &value) || value != 0) passed = false;
+    if (!stack_steal(stack, &value) || value != 1) passed = false;
+    if (*(int *)stack_peek(stack) != 18) passed = false;
+
+    for (int i = 18; i >= 2; i--) {
+        if (!stack_pop(stack, &value) || value != i) passed = false;
+    }
+
+    if (!stack_is_empty(stack)) passed = false;
+    if (stack_pop(stack, &value)) passed = false;
+    if (stack_steal(stack, &value)) passed = false;
+    stack_destroy(&stack);
+
+    // Elements de 16 octets copies depuis et vers des tampons mal alignes
+    stack = stack_create(STACK_TYPE_WORK_STEALING, &(wstack_config_t){.size = 16});
+    unsigned char in[17], out[19];
+    for (int i = 0; i < 16; i++) in[i + 1] = (unsigned char)(i * 7);
+    stack_push(stack, in + 1);
+    stack_push(stack, in + 1);
+    if (!stack_steal(stack, out + 3) || memcmp(in + 1, out + 3, 16) != 0) passed = false;
+    if (!stack_pop(stack, out + 1) || memcmp(in + 1, out + 1, 16) != 0) passed = false;
+    stack_destroy(&stack);
+
+    return (test_result){.passed = passed, .name = "Test stack_work_stealing_push_pop_steal"};
+}
+
+#define STEALING_THIEVES 3
+#define STEALING_VALUES 100000
+
+typedef struct {
+    stack_t *stack;
+    _Atomic bool *done;
+    size_t sum;
+    size_t count;
+} thief_t;
+
+static void *thief_worker(void *arg) {
+    thief_t *t = arg;
+    size_t value;
+
+    while (!atomic_load(t->done) || !stack_is_empty(t->stack)) {
+        if (stack_steal(t->stack, &value)) {
+            t->sum += value;
+            t->count++;
+        }
+    }
+
+    return NULL;
+}
+
+test_result t_stack_work_stealing_threads() {
+    bool passed = true;
+
+    stack_t *stack = stack_create(STACK_TYPE_WORK_STEALING, &(wstack_config_t){.size = sizeof(size_t)});
+    _Atomic bool done = false;
+
+    pthread_t threads[STEALING_THIEVES];
+    thief_t thieves[STEALING_THIEVES];
+    for (size_t t = 0; t < STEALING_THIEVES; t++) {
+        thieves[t] = (thief_t){.stack = stack, .done = &done};
+        pthread_create(&threads[t], NULL, thief_worker, &thieves[t]);
+    }
+
+    // Le proprietaire pousse toutes les valeurs et en retire une partie pendant que les voleurs volent
+    size_t sum = 0, count = 0;
+    for (size_t i = 0; i < STEALING_VALUES; i++) {
+        stack_push(stack, &i);
+        size_t value;
+        if (i % 3 == 0 && stack_pop(stack, &value)) {
+            sum += value;
+            count++;
+        }
+    }
+
+    atomic_store(&done, true);
+    for (size_t t = 0; t < STEALING_THIEVES; t++) {
+        pthread_join(threads[t], NULL);
+        sum += thieves[t].sum;
+        count += thieves[t].count;
+    }
+
+    // Chaque valeur doit etre retiree exactement une fois
+    if (count != STEALING_VALUES) passed = false;
+    if (sum != (size_t)STEALING_VALUES * (STEALING_VALUES - 1) / 2) passed = false;
+
+    stack_destroy(&stack);
+    return (test_result){.passed = passed, .name = "Test stack_work_stealing_threads"};
+}
+
+test_result t_stack_typed() {
+    bool passed = true;
+
+    stack_t *fixed = size_stack_create(STACK_TYPE_FIXED, 3);
+    stack_t *growable = size_stack_create(STACK_TYPE_GROWABLE, 1);
+
+    for (size_t i = 0; i < 3; i++) {
+        if (size_stack_push(fixed, i) != 0) passed = false;
+    }
+    if (size_stack_push(fixed, 3) == 0) passed = false;  // Cela ne doit pas réussir.
+
+    // Le tableau plein passe par la vtable pour s'agrandir
+    for (size_t i = 0; i < 100; i++) {
+        if (size_stack_push(growable, i) != 0) passed = false;
+        if (*size_stack_peek(growable) != i) passed = false;
+    }
+
+    // Interoperable avec l'API generique
+    size_t value = 1000;
+    stack_push(growable, &value);
+    if (*size_stack_peek(growable) != 1000) passed = false;
+    if (!size_stack_pop(growable, &value) || value != 1000) passed = false;
+    if (!stack_pop(growable, &value) || value != 99) passed = false;
+
+    for (size_t i = 99; i-- > 0;) {
+        if (!size_stack_pop(growable, &value) || value != i) passed = false;
+    }
+
+    if (!size_stack_is_empty(growable)) passed = false;
+    if (size_stack_pop(growable, &value)) passed = false;
+    if (size_stack_peek(growable) != NULL) passed = false;
+
+    stack_destroy(&fixed);
+    stack_destroy(&growable);
+    return (test_result){.passed = passed, .name = "Test stack_typed"};
+}
+
+typedef struct {
+    int calls;
+    stack_error_t last;
+} error_counter_t;
+
+static void count_errors(stack_error_t err, const char* where, void* ctx){
+    (void)where;
+    error_counter_t *counter = ctx;
+    counter->calls++;
+    counter->last = err;
+}
+
+test_result t_stack_try_errors() {
+    bool passed = true;
+    error_counter_t counter = {0};
+    stack_set_error_handler(count_errors, &counter);
+
+    stack_t *stack = stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.size = sizeof(int), .length = 2});
+    int value = 1;
+    void *top = NULL;
+
+    if (stack_try_pop(stack, &value) != STACK_ERR_EMPTY) passed = false;
+    if (stack_try_peek(stack, &top) != STACK_ERR_EMPTY || top) passed = false;
+    if (stack_try_push(NULL, &value) != STACK_ERR_NULL) passed = false;
+    if (stack_try_push(stack, &value) != STACK_OK) passed = false;
+    if (stack_try_push_n(stack, (int[]){2, 3}, 2) != STACK_ERR_FULL) passed = false;
+    if (stack_try_push(stack, &value) != STACK_OK) passed = false;
+    if (stack_try_push(stack, &value) != STACK_ERR_FULL) passed = false;
+    if (counter.calls != 5 || counter.last != STACK_ERR_FULL) passed = false;
+
+    //les fonctions historiques passent aussi par le handler
+    if (stack_push(stack, &value) != STACK_ERR_FULL || counter.calls != 6) passed = false;
+    if (stack_try_peek(stack, &top) != STACK_OK || *(int*)top != 1) passed = false;
+
+    //une pile vide n'est pas une erreur pour stack_pop
+    while (stack_pop(stack, &value));
+    if (counter.calls != 6) passed = false;
+
+    //emplace donne la cause de l'echec de la pile : une pile extensible a max_length est pleine
+    stack_t *bounded = stack_create(STACK_TYPE_GROWABLE, &(gstack_config_t){.size = sizeof(int), .initial_length = 1, .max_length = 1});
+    if (!stack_emplace(bounded) || stack_emplace(bounded)) passed = false;
+    if (counter.calls != 7 || counter.last != STACK_ERR_FULL) passed = false;
+    stack_destroy(&bounded);
+
+    //un point de reprise au-dessus de la profondeur passe aussi par le handler
+    if (stack_rollback(stack, 1) != STACK_ERR_RANGE || counter.calls != 8 || counter.last != STACK_ERR_RANGE) passed = false;
+
+    stack_set_error_handler(NULL, NULL);
+    stack_destroy(&stack);
+
+    return (test_result){.passed = passed, .name = "Test stack_try_errors"};
+}
+
+test_result t_stack_unsafe() {
+    bool passed = true;
+
+    stack_t *stack = stack_create(STACK_TYPE_DYNAMIC, &(dstack_config_t){.size = sizeof(size_t), .chunk_length = 4});
+
+    for (size_t i = 0; i < 10; i++)
+        if (stack_push_unsafe(stack, &i) != STACK_OK) passed = false;
+
+    if (*(size_t*)stack_peek_unsafe(stack) != 9) passed = false;
+
+    for (size_t i = 10; i-- > 0;){
+        size_t value;
+        if (stack_pop_unsafe(stack, &value) != STACK_OK || value != i) passed = false;
+    }
+
+    if (!stack_is_empty_unsafe(stack)) passed = false;
+    if (stack_pop_unsafe(stack, NULL) != STACK_ERR_EMPTY) passed = false;
+
+    stack_destroy(&stack);
+
+    return (test_result){.passed = passed, .name = "Test stack_unsafe"};
+}
+
+test_result t_stack_mapped_reopen() {
+    bool passed = true;
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/stack_test_%d.mstack", (int)getpid());
+    remove(path);
+
+    mstack_config_t config = {.path = path, .size = sizeof(size_t), .initial_length = 4};
+    stack_t *stack = stack_create(STACK_TYPE_MAPPED, &config);
+    if (!stack) return (test_result){.passed = false, .name = "Test stack_mapped_reopen"};
+
+    //depasse la capacite initiale pour passer par ftruncate/mremap
+    for (size_t i = 0; i < 1000; i++)
+        if (stack_push(stack, &i)) passed = false;
+
+    size_t value;
+    if (!stack_pop(stack, &value) || value != 999) passed = false;
+    stack_destroy(&stack);
+
+    stack = stack_create(STACK_TYPE_MAPPED, &config);
+    if (!stack) return (test_result){.passed = false, .name = "Test stack_mapped_reopen"};
+
+    if (*(size_t*)stack_peek(stack) != 998) passed = false;
+    for (size_t i = 999; i-- > 0;)
+        if (!stack_pop(stack, &value) || value != i) passed = false;
+    if (!stack_is_empty(stack)) passed = false;
+    stack_destroy(&stack);
+
+    //un fichier cree avec une autre taille d'element est refuse
+    stack = stack_create(STACK_TYPE_MAPPED, &(mstack_config_t){.path = path, .size = sizeof(int)});
+    if (stack){
+        passed = false;
+        stack_destroy(&stack);
+    }
+
+    remove(path);
+
+    return (test_result){.passed = passed, .name = "Test stack_mapped_reopen"};
+}
+
+test_result t_stack_save_load() {
+    bool passed = true;
+    FILE *file = tmpfile();
+    if (!file) return (test_result){.passed = false, .name = "Test stack_save_load"};
+
+    //plusieurs blocs dont le dernier est partiel
+    stack_t *source = stack_create(STACK_TYPE_DYNAMIC, &(dstack_config_t){.size = sizeof(size_t), .chunk_length = 8});
+    for (size_t i = 0; i < 21; i++) stack_push(source, &i);
+
+    if (stack_save(source, file) != STACK_OK) passed = false;
+    if (*(size_t*)stack_peek(source) != 20) passed = false;
+
+    //chaque type relit le snapshot, la pile concurrente passe par l'implementation generique
+    stack_t *targets[] = {
+        stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.size = sizeof(size_t), .length = 32}),
+        stack_create(STACK_TYPE_GROWABLE, &(gstack_config_t){.size = sizeof(size_t), .initial_length = 2}),
+        stack_create(STACK_TYPE_DYNAMIC, &(dstack_config_t){.size = sizeof(size_t), .chunk_length = 5}),
+        stack_create(STACK_TYPE_CONCURRENT, &(cstack_config_t){.size = sizeof(size_t)}),
+    };
+
+    for (size_t t = 0; t < sizeof(targets) / sizeof(targets[0]); t++) {
+        rewind(file);
+        if (stack_load(targets[t], file) != STACK_OK) passed = false;
+
+        size_t value;
+        for (size_t i = 21; i-- > 0;)
+            if (!stack_pop(targets[t], &value) || value != i) passed = false;
+        if (!stack_is_empty(targets[t])) passed = false;
+
+        stack_destroy(&targets[t]);
+    }
+
+    //un snapshot est refuse par une pile trop petite ou avec une autre taille d'element
+    rewind(file);
+    stack_t *small = stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.size = sizeof(size_t), .length = 4});
+    if (stack_load(small, file) != STACK_ERR_FULL || !stack_is_empty(small)) passed = false;
+    stack_destroy(&small);
+
+    rewind(file);
+    stack_t *other = stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.size = sizeof(int), .length = 32});
+    if (stack_load(other, file) == STACK_OK) passed = false;
+    stack_destroy(&other);
+
+    for (size_t i = 21; i-- > 0;) {
+        size_t value;
+        if (!stack_pop(source, &value) || value != i) passed = false;
+    }
+
+    stack_destroy(&source);
+    fclose(file);
+
+    return (test_result){.passed = passed, .name = "Test stack_save_load"};
+}
+
+#ifdef STACK_STATS
+test_result t_stack_stats() {
+    bool passed = true;
+
+    stack_t *fixed = stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.size = sizeof(int), .length = 4});
+    int value = 7;
+
+    for (int i = 0; i < 6; i++) stack_try_push(fixed, &value);
+    stack_pop(fixed, &value);
+    stack_pop_n(fixed, NULL, 2, STACK_ORDER_TOP_DOWN);
+
+    stack_stats_t stats = stack_get_stats(fixed);
+    if (stats.pushes != 4 || stats.failed_pushes != 2 || stats.pops != 3) passed = false;
+    if (stats.depth != 1 || stats.high_water != 4) passed = false;
+    if (stats.bytes_allocated != FSTACK_HEADER_BYTES + 4 * sizeof(int) || stats.allocator_calls != 1) passed = false;
+    stack_destroy(&fixed);
+
+    //les blocs liberes sont decomptes de bytes_allocated
+    stack_t *dynamic = stack_create(STACK_TYPE_DYNAMIC, &(dstack_config_t){.size = sizeof(int), .chunk_length = 2});
+    for (int i = 0; i < 9; i++) stack_push(dynamic, &i);
+    size_t peak_bytes = stack_get_stats(dynamic).bytes_allocated;
+    while (stack_pop(dynamic, &value));
+
+    stats = stack_get_stats(dynamic);
+    if (stats.pushes != 9 || stats.pops != 9 || stats.depth != 0 || stats.high_water != 9) passed = false;
+    if (stats.bytes_allocated >= peak_bytes || stats.allocator_calls < 5) passed = false;
+    stack_destroy(&dynamic);
+
+    return (test_result){.passed = passed, .name = "Test stack_stats"};
+}
+#endif
+
+test_result t_stack_sized_ops() {
+    bool passed = true;
+    //tailles specialisees et quelques tailles voisines qui gardent la version generique
+    const size_t sizes[] = {1, 2, 3, 4, 8, 12, 16, 32, 64, 65};
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t size = sizes[s];
+        stack_t *stacks[] = {
+            stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.size = size, .length = 40}),
+            stack_create(STACK_TYPE_DYNAMIC, &(dstack_config_t){.size = size, .chunk_length = 7}),
+        };
+
+        for (size_t t = 0; t < 2; t++) {
+            unsigned char value[66], popped[66];
+
+            for (int i = 0; i < 40; i++) {
+                memset(value, i, size);
+                if (stack_push(stacks[t], value)) passed = false;
+            }
+
+            for (int i = 39; i >= 0; i--) {
+                memset(value, i, size);
+                memset(popped, 0xff, sizeof(popped));
+                if (!stack_pop(stacks[t], popped) || memcmp(value, popped, size) || popped[size] != 0xff) passed = false;
+            }
+
+            if (!stack_is_empty(stacks[t])) passed = false;
+            stack_destroy(&stacks[t]);
+        }
+    }
+
+    return (test_result){.passed = passed, .name = "Test stack_sized_ops"};
+}
+
+test_result t_stack_fixed_buffer_options() {
+    bool passed = true;
+
+    stack_t *aligned = stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.size = 24, .length = 10, .alignment = 64});
+    if (!aligned || ((uintptr_t)((fstack_t *)aligned)->data & 63)) passed = false;
+    if (aligned && *(char *)((fstack_t *)aligned)->data != 0) passed = false;
+    stack_destroy(&aligned);
+
+    if (stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.size = 8, .length = 10, .alignment = 48})) passed = false;
+
+    //4 Mo : le tableau est aligne sur une page de 2 Mo et toutes ses pages sont touchees a la creation
+    fstack_config_t config = {
+        .size = sizeof(size_t),
+        .length = 1 << 19,
+        .huge_pages = true,
+        .prefault = true,
+        .lock = true,
+        .no_zero = true
+    };
+    stack_t *stack = stack_create(STACK_TYPE_FIXED, &config);
+    if (!stack) return (test_result){.passed = false, .name = "Test stack_fixed_buffer_options"};
+
+    if ((uintptr_t)((fstack_t *)stack)->data & ((2 << 20) - 1)) passed = false;
+
+    for (size_t i = 0; i < config.length; i++) stack_push(stack, &i);
+    for (size_t i = config.length; i-- > 0;) {
+        size_t value;
+        if (!stack_pop(stack, &value) || value != i) passed = false;
+    }
+
+    stack_destroy(&stack);
+
+    return (test_result){.passed = passed, .name = "Test stack_fixed_buffer_options"};
+}
+
+test_result t_stack_persistent_fork() {
+    bool passed = true;
+
+    stack_t *root = stack_create(STACK_TYPE_PERSISTENT, &(pstack_config_t){.size = sizeof(int)});
+    if (!root) return (test_result){.passed = false, .name = "Test stack_persistent_fork"};
+
+    for (int i = 0; i < 10; i++) stack_push(root, &i);
+
+    //deux branches qui partagent les 10 elements de root puis divergent
+    stack_t *left = stack_fork(root);
+    stack_t *right = stack_fork(root);
+    int value;
+
+    for (int i = 0; i < 5; i++) stack_pop(left, &value);
+    value = 100;
+    stack_push(left, &value);
+
+    value = 200;
+    stack_push(right, &value);
+
+    if (*(int *)stack_peek(root) != 9) passed = false;
+    if (*(int *)stack_peek(left) != 100) passed = false;
+    if (*(int *)stack_peek(right) != 200) passed = false;
+
+    //root est detruite avant ses branches : les noeuds partages restent valides
+    stack_destroy(&root);
+
+    const int expected_left[] = {100, 4, 3, 2, 1, 0};
+    for (size_t i = 0; i < 6; i++)
+        if (!stack_pop(left, &value) || value != expected_left[i]) passed = false;
+    if (!stack_is_empty(left)) passed = false;
+
+    if (!stack_pop(right, &value) || value != 200) passed = false;
+    stack_t *nested = stack_fork(right);
+    for (int i = 9; i >= 0; i--)
+        if (!stack_pop(right, &value) || value != i) passed = false;
+    if (*(int *)stack_peek(nested) != 9) passed = false;
+
+    stack_destroy(&left);
+    stack_destroy(&right);
+    stack_destroy(&nested);
+
+    //stack_fork n'est pas supporte par les autres types
+    stack_t *fixed = stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.size = sizeof(int), .length = 4});
+    if (stack_try_push(fixed, &value) || stack_fork(fixed)) passed = false;
+    stack_destroy(&fixed);
+
+    return (test_result){.passed = passed, .name = "Test stack_persistent_fork"};
+}
+
+test_result t_stack_mark_rollback() {
+    bool passed = true;
+
+    stack_t *stacks[] = {
+        stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.size = sizeof(int), .length = 64}),
+        stack_create(STACK_TYPE_DYNAMIC, &(dstack_config_t){.size = sizeof(int), .chunk_length = 4}),
+        stack_create(STACK_TYPE_GROWABLE, &(gstack_config_t){.size = sizeof(int)}),
+        stack_create(STACK_TYPE_PERSISTENT, &(pstack_config_t){.size = sizeof(int)}),
+    };
+
+    for (size_t s = 0; s < sizeof(stacks) / sizeof(stacks[0]); s++){
+        stack_t *stack = stacks[s];
+        if (!stack){
+            passed = false;
+            continue;
+        }
+
+        for (int i = 0; i < 6; i++) stack_push(stack, &i);
+        stack_mark_t mark = stack_mark(stack);
+
+        //ajouts speculatifs sur plusieurs blocs de la pile dynamique
+        for (int i = 100; i < 111; i++) stack_push(stack, &i);
+        stack_t *fork = stack->type == STACK_TYPE_PERSISTENT ? stack_fork(stack) : NULL;
+
+        if (stack_rollback(stack, mark) != STACK_OK || *(int *)stack_peek(stack) != 5) passed = false;
+        if (stack_rollback(stack, mark + 1) != STACK_ERR_RANGE) passed = false;
+
+        int value = 6;
+        stack_push(stack, &value);
+        for (int i = 6; i >= 0; i--)
+            if (!stack_pop(stack, &value) || value != i) passed = false;
+
+        for (int i = 0; i < 9; i++) stack_push(stack, &i);
+        stack_clear(stack);
+        if (!stack_is_empty(stack) || stack_mark(stack) != 0) passed = false;
+
+        //la version creee avant le rollback garde tous ses elements
+        if (fork){
+            if (*(int *)stack_peek(fork) != 110) passed = false;
+            stack_destroy(&fork);
+        }
+
+        stack_destroy(&stacks[s]);
+    }
+
+    //sans truncate, stack_clear retire les elements un par un
+    stack_t *concurrent = stack_create(STACK_TYPE_CONCURRENT, &(cstack_config_t){.size = sizeof(int)});
+    for (int i = 0; i < 10; i++) stack_push(concurrent, &i);
+    stack_clear(concurrent);
+    if (!stack_is_empty(concurrent) || stack_rollback(concurrent, 0) != STACK_ERR_UNSUPPORTED) passed = false;
+    stack_destroy(&concurrent);
+
+    return (test_result){.passed = passed, .name = "Test stack_mark_rollback"};
+}
+
+static bool collect_int(void* elem, void* ctx){
+    int **out = ctx;
+    *(*out)++ = *(int *)elem;
+    return *(int *)elem != 12; //le parcours s'arrete apres 12
+}
+
+typedef struct {
+    stack_t *stack;
+    size_t index;
+    bool consistent;
+} reentrant_visit_t;
+
+//Relit la pile pendant le parcours : l'element visite doit etre celui que stack_at donne a cette profondeur
+static bool visit_reentrant(void* elem, void* ctx){
+    reentrant_visit_t *visit = ctx;
+    size_t depth = stack_size(visit->stack) - 1 - visit->index++;
+    if (stack_at(visit->stack, depth) != elem || stack_find(visit->stack, elem) == NULL) visit->consistent = false;
+    return true;
+}
+
+test_result t_stack_at_foreach_find() {
+    bool passed = true;
+
+    stack_t *stacks[] = {
+        stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.size = sizeof(int), .length = 64}),
+        stack_create(STACK_TYPE_DYNAMIC, &(dstack_config_t){.size = sizeof(int), .chunk_length = 4}),
+        stack_create(STACK_TYPE_GROWABLE, &(gstack_config_t){.size = sizeof(int)}),
+        stack_create(STACK_TYPE_PERSISTENT, &(pstack_config_t){.size = sizeof(int)}),
+    };
+
+    for (size_t s = 0; s < sizeof(stacks) / sizeof(stacks[0]); s++){
+        stack_t *stack = stacks[s];
+        if (!stack){
+            passed = false;
+            continue;
+        }
+
+        //0..19 puis 7 une deuxieme fois au sommet
+        for (int i = 0; i < 20; i++) stack_push(stack, &i);
+        int value = 7;
+        stack_push(stack, &value);
+
+        if (stack_size(stack) != 21) passed = false;
+        if (*(int *)stack_at(stack, 0) != 7 || *(int *)stack_at(stack, 1) != 19 || *(int *)stack_at(stack, 20) != 0) passed = false;
+        if (stack_at(stack, 21) != NULL) passed = false;
+
+        int seen[21], *cursor = seen;
+        if (stack_foreach(stack, STACK_ORDER_BOTTOM_UP, collect_int, &cursor) != STACK_OK || cursor - seen != 13) passed = false;
+        for (int i = 0; i < 13; i++) if (seen[i] != i) passed = false;
+
+        cursor = seen;
+        stack_foreach(stack, STACK_ORDER_TOP_DOWN, collect_int, &cursor);
+        if (cursor - seen != 9 || seen[0] != 7 || seen[1] != 19 || seen[8] != 12) passed = false;
+
+        //visit peut relire la pile parcourue
+        reentrant_visit_t reentrant = {.stack = stack, .consistent = true};
+        stack_foreach(stack, STACK_ORDER_BOTTOM_UP, visit_reentrant, &reentrant);
+        if (!reentrant.consistent || reentrant.index != 21 || *(int *)stack_peek(stack) != 7) passed = false;
+
+        //le 7 trouve est celui du sommet, pas celui a la profondeur 13
+        if (stack_find(stack, &value) != stack_at(stack, 0)) passed = false;
+        value = 0;
+        if (stack_find(stack, &value) != stack_at(stack, 20)) passed = false;
+        value = 42;
+        if (stack_find(stack, &value) != NULL) passed = false;
+
+        stack_destroy(&stacks[s]);
+    }
+
+    //recherche SSE2 (8 octets) et generique (3 octets) a toutes les positions
+    stack_t *wide = stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.size = sizeof(long long), .length = 37});
+    stack_t *odd = stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.size = 3, .length = 37});
+    for (long long i = 0; i < 37; i++){
+        long long w = i * 0x100000001ll;
+        char o[3] = {(char)i, 1, 2};
+        stack_push(wide, &w);
+        stack_push(odd, o);
+    }
+    for (long long i = 0; i < 37; i++){
+        long long w = i * 0x100000001ll;
+        char o[3] = {(char)i, 1, 2};
+        if (stack_find(wide, &w) != stack_at(wide, (size_t)(36 - i))) passed = false;
+        if (stack_find(odd, o) != stack_at(odd, (size_t)(36 - i))) passed = false;
+    }
+    long long half = 5; //une seule moitie de 5 * 0x100000001 : pas egal
+    if (stack_find(wide, &half) != NULL) passed = false;
+    stack_destroy(&wide);
+    stack_destroy(&odd);
+
+    stack_t *concurrent = stack_create(STACK_TYPE_CONCURRENT, &(cstack_config_t){.size = sizeof(int)});
+    if (stack_at(concurrent, 0) || stack_foreach(concurrent, STACK_ORDER_TOP_DOWN, collect_int, NULL) != STACK_ERR_UNSUPPORTED) passed = false;
+    stack_destroy(&concurrent);
+
+    return (test_result){.passed = passed, .name = "Test stack_at_foreach_find"};
+}
+
+test_result t_stack_indexed() {
+    bool passed = true;
+
+    stack_t *indexed[] = {
+        stack_create(STACK_TYPE_INDEXED, &(istack_config_t){
+            .type = STACK_TYPE_DYNAMIC, .config = &(dstack_config_t){.size = sizeof(int), .chunk_length = 8},
+            .initial_capacity = 4, .bloom_counters = 1000}),
+        stack_create(STACK_TYPE_INDEXED, &(istack_config_t){
+            .type = STACK_TYPE_FIXED, .config = &(fstack_config_t){.size = sizeof(int), .length = 4096}}),
+    };
+
+    for (size_t s = 0; s < sizeof(indexed) / sizeof(indexed[0]); s++){
+        stack_t *stack = indexed[s];
+        if (!stack){
+            passed = false;
+            continue;
+        }
+
+        //melange de push, pop, push_n, pop_n et rollback sur peu de valeurs distinctes (doublons et
+        //suppressions dans l'index), compare a une recherche lineaire
+        unsigned seed = 12345;
+        for (int round = 0; round < 2000; round++){
+            seed = seed * 1103515245 + 12345;
+            int value = (int)((seed >> 16) % 97);
+
+            switch ((seed >> 8) % 5){
+            case 0: case 1: stack_push(stack, &value); break;
+            case 2: stack_try_pop(stack, NULL); break;
+            case 3: {
+                int values[3] = {value, value + 1, value};
+                stack_push_n(stack, values, 3);
+                break;
+            }
+            default: {
+                stack_mark_t mark = stack_mark(stack);
+                for (int i = 0; i < 5; i++) stack_push(stack, &value);
+                if (round % 2) stack_rollback(stack, mark);
+                else stack_pop_n(stack, NULL, 2, STACK_ORDER_TOP_DOWN);
+            }
+            }
+
+            for (int v = -1; v <= 98; v += 11){
+                bool expected = false;
+                for (size_t d = 0; stack_at(stack, d); d++)
+                    if (*(int *)stack_at(stack, d) == v) expected = true;
+                if (stack_contains(stack, &v) != expected) passed = false;
+            }
+        }
+
+        stack_clear(stack);
+        int value = 3;
+        if (stack_contains(stack, &value)) passed = false;
+
+        stack_destroy(&indexed[s]);
+    }
+
+    //stack_contains marche aussi sans index (recherche lineaire)
+    stack_t *plain = stack_create(STACK_TYPE_PERSISTENT, &(pstack_config_t){.size = sizeof(int)});
+    int value = 5;
+    stack_push(plain, &value);
+    if (!stack_contains(plain, &value)) passed = false;
+    value = 6;
+    if (stack_contains(plain, &value)) passed = false;
+    stack_destroy(&plain);
+
+    //une pile concurrente ne peut pas etre indexee
+    if (stack_create(STACK_TYPE_INDEXED, &(istack_config_t){
+            .type = STACK_TYPE_CONCURRENT, .config = &(cstack_config_t){.size = sizeof(int)}}))
+        passed = false;
+
+    return (test_result){.passed = passed, .name = "Test stack_indexed"};
+}
+
+//Remplit un enregistrement de test : len octets qui dependent de i
+static void fill_record(char* record, size_t len, int i){
+    for (size_t j = 0; j < len; j++) record[j] = (char)(i * 31 + (int)j);
+}
+
+static bool check_record(const char* record, size_t len, int i){
+    for (size_t j = 0; j < len; j++)
+        if (record[j] != (char)(i * 31 + (int)j)) return false;
+    return true;
+}
+
+test_result t_stack_variable_records() {
+    bool passed = true;
+
+    stack_t *stack = stack_create(STACK_TYPE_VARIABLE, &(vstack_config_t){.initial_bytes = 64});
+    if (!stack) return (test_result){.passed = false, .name = "Test stack_variable_records"};
+
+    //tailles de 0 a plusieurs Ko : le tableau est agrandi plusieurs fois
+    static const size_t lens[] = {16, 0, 1, 7, 8, 9, 300, 4000, 24, 5};
+    static char record[4096];
+    const int count = (int)(sizeof(lens) / sizeof(lens[0]));
+
+    for (int i = 0; i < count; i++){
+        fill_record(record, lens[i], i);
+        if (stack_push_record(stack, record, lens[i]) != STACK_OK) passed = false;
+    }
+
+    size_t len = 0;
+    char *top = stack_peek_record(stack, &len);
+    if (!top || len != 5 || !check_record(top, len, count - 1) || stack_size(stack) != (size_t)count) passed = false;
+    if (stack_at(stack, 2) == NULL || !check_record(stack_at(stack, 2), lens[count - 3], count - 3)) passed = false;
+
+    //mark / rollback et ajout sur place
+    stack_mark_t mark = stack_mark(stack);
+    fill_record(stack_emplace_record(stack, 100), 100, 42);
+    if (stack_peek_record(stack, &len) == NULL || len != 100 || !check_record(stack_peek_record(stack, NULL), 100, 42)) passed = false;
+    stack_rollback(stack, mark);
+
+    //snapshot : les longueurs sont ecrites avec les enregistrements
+    FILE *file = tmpfile();
+    stack_t *copy = stack_create(STACK_TYPE_VARIABLE, &(vstack_config_t){.alignment = 16});
+    if (!file || stack_save(stack, file) != STACK_OK) passed = false;
+    if (file) rewind(file);
+    if (!file || stack_load(copy, file) != STACK_OK || stack_size(copy) != (size_t)count) passed = false;
+    if (file) fclose(file);
+
+    //un tampon trop petit laisse l'enregistrement dans la pile
+    char small[8];
+    if (stack_pop_record(stack, small, sizeof(small), &len) != STACK_OK || len != 5 || !check_record(small, 5, count - 1)) passed = false;
+    if (stack_pop_record(stack, small, sizeof(small), &len) != STACK_ERR_FULL || len != 24) passed = false;
+
+    for (int i = count - 2; i >= 0; i--){
+        if (stack_pop_record(stack, record, sizeof(record), &len) != STACK_OK) passed = false;
+        if (len != lens[i] || !check_record(record, len, i)) passed = false;
+    }
+    if (!stack_is_empty(stack) || stack_pop_record(stack, NULL, 0, NULL) != STACK_ERR_EMPTY) passed = false;
+
+    //la copie rechargee avec un autre alignement contient les memes enregistrements
+    for (int i = count - 1; i >= 0; i--){
+        char *view = stack_pop_record_view(copy, &len);
+        if (!view || len != lens[i] || !check_record(view, len, i)) passed = false;
+    }
+    stack_destroy(&copy);
+
+    //ajout par lots, retrait sans copie : stack_pop et stack_pop_n ne connaissent pas la taille du tampon
+    const char packed[] = "abcdefghij";
+    const size_t packed_lens[] = {3, 0, 5, 2};
+    char out[16] = {0};
+    if (stack_push_records(stack, packed, packed_lens, 4) != STACK_OK || stack_size(stack) != 4) passed = false;
+    if (stack_pop_n(stack, out, 3, STACK_ORDER_BOTTOM_UP) != 0 || stack_size(stack) != 4) passed = false;
+    if (stack_try_pop(stack, out) != STACK_ERR_UNSUPPORTED || stack_pop(stack, out) || stack_size(stack) != 4) passed = false;
+    if (stack_try_pop(stack, NULL) != STACK_OK || stack_size(stack) != 3) passed = false;
+    if (stack_pop_n(stack, NULL, 3, STACK_ORDER_TOP_DOWN) != 3 || stack_size(stack) != 0) passed = false;
+    if (stack_pop_record(stack, out, sizeof(out), &len) != STACK_ERR_EMPTY) passed = false;
+
+    //une longueur qui deborde de l'espace adressable est un debordement de capacite, pas un manque de memoire
+    if (stack_push_record(stack, packed, SIZE_MAX) != STACK_ERR_FULL || stack_size(stack) != 0) passed = false;
+
+    //pas de taille d'element : push, find et l'index ne sont pas supportes
+    int value = 1;
+    if (stack_try_push(stack, &value) != STACK_ERR_UNSUPPORTED || stack_find(stack, &value)) passed = false;
+
+    stack_destroy(&stack);
+
+    return (test_result){.passed = passed, .name = "Test stack_variable_records"};
+}
+
+test_result t_stack_reserved() {
+    bool passed = true;
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    stack_t *stack = stack_create(STACK_TYPE_RESERVED, &(rstack_config_t){
+        .size = sizeof(int), .max_length = 100000, .commit_bytes = page, .decommit_bytes = page});
+    if (!stack) return (test_result){.passed = false, .name = "Test stack_reserved"};
+
+    rstack_t *rstack = (rstack_t*)stack;
+    if (rstack->committed != 0) passed = false;
+
+    int value = 0;
+    stack_push(stack, &value);
+    int *bottom = stack_peek(stack);
+
+    //le tableau n'est jamais deplace : l'adresse du premier element reste valide
+    for (int i = 1; i < 50000; i++) stack_push(stack, &i);
+    if (stack_at(stack, 49999) != bottom || *bottom != 0) passed = false;
+    if (rstack->committed < 50000 * sizeof(int) || rstack->committed > 50000 * sizeof(int) + page) passed = false;
+
+    //des pop profonds liberent les pages, en gardant une marge au-dessus du sommet
+    for (int i = 49999; i >= 100; i--)
+        if (!stack_pop(stack, &value) || value != i) passed = false;
+    if (rstack->committed > 100 * sizeof(int) + 3 * page) passed = false;
+
+    //un va-et-vient autour du sommet ne recommite ni ne decommite
+    size_t committed = rstack->committed;
+    for (int round = 0; round < 100; round++){
+        for (int i = 0; i < 200; i++) stack_push(stack, &i);
+        stack_pop_n(stack, NULL, 200, STACK_ORDER_TOP_DOWN);
+    }
+    if (rstack->committed != committed) passed = false;
+
+    int *view = stack_pop_view(stack);
+    if (!view || *view != 99) passed = false;
+
+    stack_clear(stack);
+    if (!stack_is_empty(stack) || *bottom != 0) passed = false;
+
+    //la plage reservee est la capacite maximale
+    int values[1000] = {0};
+    for (int i = 0; i < 100; i++) stack_push_n(stack, values, 1000);
+    if (stack_try_push(stack, &value) != STACK_ERR_FULL || stack_size(stack) != 100000) passed = false;
+
+    stack_destroy(&stack);
+
+    return (test_result){.passed = passed, .name = "Test stack_reserved"};
+}
+
+test_result t_stack_trim() {
+    bool passed = true;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+    // Pile extensible sans politique : le tableau garde sa taille jusqu'a stack_shrink_to_fit
+    stack_t *stack = stack_create(STACK_TYPE_GROWABLE, &(gstack_config_t){.size = sizeof(int), .initial_length = 16});
+    for (int i = 0; i < 4096; i++) stack_push(stack, &i);
+    stack_pop_n(stack, NULL, 4086, STACK_ORDER_TOP_DOWN);
+
+    if (stack_shrink_to_fit(stack) < (4096 - 10) * sizeof(int)) passed = false;
+    if (stack_shrink_to_fit(stack) != 0) passed = false;
+    if (*(int*)stack_peek(stack) != 9 || *(int*)stack_at(stack, 9) != 0) passed = false;
+    stack_destroy(&stack);
+
+    // Avec la politique : le tableau suit la profondeur, sans se reduire a chaque pop
+    stack = stack_create(STACK_TYPE_GROWABLE, &(gstack_config_t){
+        .size = sizeof(int),
+        .initial_length = 16,
+        .trim = {.low_watermark = 0.25}
+    });
+    for (int i = 0; i < 4096; i++) stack_push(stack, &i);
+
+    int value;
+    for (int i = 4095; i >= 10; i--) {
+        if (stack_try_pop(stack, &value) != STACK_OK || value != i) passed = false;
+        // entre deux trims, la pile a au moins 2 fois moins d'elements que de capacite et en garde au plus 4 fois plus
+        gstack_t *g = (gstack_t*)stack;
+        if (g->top > 16 && g->length > 4 * g->top + 4) passed = false;
+    }
+    if (stack_shrink_to_fit(stack) > 40 * sizeof(int)) passed = false;
+
+    for (int i = 10; i < 100; i++) stack_push(stack, &i);
+    for (int i = 99; i >= 0; i--) {
+        if (stack_try_pop(stack, &value) != STACK_OK || value != i) passed = false;
+    }
+    stack_destroy(&stack);
+
+    // Pile fixe : les pages au-dessus du sommet sont rendues, le tableau reste utilisable
+    size_t length = 64 * page / sizeof(int);
+    stack = stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.size = sizeof(int), .length = length});
+    for (size_t i = 0; i < length; i++) { int v = (int)i; stack_push(stack, &v); }
+    stack_rollback(stack, 10);
+
+    size_t released = stack_shrink_to_fit(stack);
+    if (released < 62 * page || released % page != 0) passed = false;
+    if (stack_shrink_to_fit(stack) != 0) passed = false;
+    if (*(int*)stack_peek(stack) != 9) passed = false;
+    for (size_t i = 10; i < length; i++) { int v = (int)i; if (stack_try_push(stack, &v) != STACK_OK) passed = false; }
+    if (*(int*)stack_at(stack, length - 1) != 0 || *(int*)stack_peek(stack) != (int)length - 1) passed = false;
+    stack_destroy(&stack);
+
+    // Seules les pages touchees depuis la derniere liberation sont rendues et comptees
+    stack = stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.size = sizeof(int), .length = length});
+    for (size_t i = 0; i < 8 * page / sizeof(int); i++) { int v = (int)i; stack_push(stack, &v); }
+    stack_clear(stack);
+    released = stack_shrink_to_fit(stack);
+    if (released < 7 * page || released > 8 * page) passed = false;
+    if (stack_shrink_to_fit(stack) != 0) passed = false;
+    stack_destroy(&stack);
+
+    stack = stack_create(STACK_TYPE_FIXED, &(fstack_config_t){
+        .size = sizeof(int),
+        .length = length,
+        .trim = {.low_watermark = 0.25, .headroom = 2}
+    });
+    for (size_t i = 0; i < 8 * page / sizeof(int); i++) { int v = (int)i; stack_push(stack, &v); }
+    stack_clear(stack);
+#ifdef STACK_STATS
+    if (stack_get_stats(stack).bytes_trimmed > 8 * page) passed = false;
+#endif
+    if (stack_shrink_to_fit(stack) > page) passed = false;
+    stack_destroy(&stack);
+
+    // Pile fixe avec la politique : le trim se fait pendant les pop, stack_shrink_to_fit n'a presque plus rien a rendre
+    stack = stack_create(STACK_TYPE_FIXED, &(fstack_config_t){
+        .size = sizeof(int),
+        .length = length,
+        .trim = {.low_watermark = 0.25, .headroom = 2, .min_bytes = page}
+    });
+    for (size_t i = 0; i < length; i++) { int v = (int)i; stack_push(stack, &v); }
+    for (size_t i = length; i > 10; i--) stack_pop(stack, NULL);
+    if (stack_shrink_to_fit(stack) > 2 * page) passed = false;
+    if (*(int*)stack_peek(stack) != 9) passed = false;
+
+    // un nouveau pic rearme la politique sur tout le tableau
+    for (size_t i = 10; i < length; i++) { int v = (int)i; stack_push(stack, &v); }
+    for (size_t i = length; i > 10; i--) stack_pop(stack, NULL);
+    if (stack_shrink_to_fit(stack) > 2 * page) passed = false;
+    stack_destroy(&stack);
+
+    // Une politique qui oscillerait est refusee
+    if (stack_create(STACK_TYPE_FIXED, &(fstack_config_t){.size = 1, .length = 8, .trim = {.low_watermark = 0.6}})) passed = false;
+
+    // Pile d'enregistrements
+    stack = stack_create(STACK_TYPE_VARIABLE, &(vstack_config_t){.initial_bytes = 64});
+    char record[100] = {0};
+    for (int i = 0; i < 1000; i++) stack_push_record(stack, record, sizeof(record));
+    stack_rollback(stack, 1);
+    if (stack_shrink_to_fit(stack) < 999 * sizeof(record)) passed = false;
+    size_t len;
+    if (!stack_peek_record(stack, &len) || len != sizeof(record)) passed = false;
+    stack_destroy(&stack);
+
+    // Pile dynamique : le bloc de reserve est libere
+    stack = stack_create(STACK_TYPE_DYNAMIC, &(dstack_config_t){.size = sizeof(int), .chunk_length = 64});
+    for (int i = 0; i < 200; i++) stack_push(stack, &i);
+    stack_rollback(stack, 100);
+    if (stack_shrink_to_fit(stack) < 64 * sizeof(int)) passed = false;
+    if (stack_shrink_to_fit(stack) != 0) passed = false;
+    if (*(int*)stack_peek(stack) != 99) passed = false;
+
+#ifdef STACK_STATS
+    if (stack_get_stats(stack).bytes_trimmed < 64 * sizeof(int)) passed = false;
+#endif
+    stack_destroy(&stack);
+
+    return (test_result){.passed = passed, .name = "Test stack_trim"};
+}
+
+test_result t_stack_init_in() {
+    bool passed = true;
+
+    fstack_config_t config = {.size = sizeof(int), .length = 8};
+    size_t bytes = stack_init_in_bytes(STACK_TYPE_FIXED, &config);
+    _Alignas(max_align_t) unsigned char buffer[512];
+    if (bytes == 0 || bytes + 1 > sizeof(buffer)) return (test_result){.passed = false, .name = "Test stack_init_in"};
+
+    // Zone mal alignee : la pile commence a la premiere adresse alignee
+    memset(buffer, 0xAB, sizeof(buffer));
+    stack_t *stack = stack_init_in(buffer + 1, bytes, STACK_TYPE_FIXED, &config);
+    if (!stack || (unsigned char*)stack < buffer + 1 || (unsigned char*)stack >= buffer + 1 + bytes) passed = false;
+
+    if (stack){
+        for (int i = 0; i < 8; i++) stack_push(stack, &i);
+        int value = 0;
+        if (stack_try_push(stack, &value) != STACK_ERR_FULL) passed = false;
+        for (int i = 8; i-- > 0;) if (!stack_pop(stack, &value) || value != i) passed = false;
+
+#ifdef STACK_STATS
+        if (stack_get_stats(stack).allocator_calls != 0 || stack_get_stats(stack).bytes_allocated != 0) passed = false;
+#endif
+        stack_destroy(&stack);
+        if (stack) passed = false;
+    }
+    // La zone reste a l'appelant : rien n'est ecrit en dehors
+    if (buffer[0] != 0xAB || buffer[bytes + 1] != 0xAB) passed = false;
+
+    // Zone trop petite, type non supporte
+    if (stack_init_in(buffer + 1, bytes - 1, STACK_TYPE_FIXED, &config)) passed = false;
+    if (stack_init_in(buffer, sizeof(buffer), STACK_TYPE_DYNAMIC, &(dstack_config_t){.size = sizeof(int)})) passed = false;
+    if (stack_init_in_bytes(STACK_TYPE_DYNAMIC, &(dstack_config_t){.size = sizeof(int)}) != 0) passed = false;
+
+    return (test_result){.passed = passed, .name = "Test stack_init_in"};
+}
+
 test_result t_stack_destroy_empty() {
     bool passed = true;
 
@@ -419,6 +1912,38 @@ const unit_test_t tests[] = {
     t_stack_peek,
     t_stack_fixed_overflow,
     t_stack_dynamic_resize,
+    t_stack_dynamic_chunk_boundary,
+    t_stack_growable_push_pop,
+    t_stack_growable_max_length,
+    t_stack_custom_allocator,
+    t_stack_dynamic_pool,
+    t_stack_push_pop_n,
+    t_stack_fixed_push_n_overflow,
+    t_stack_emplace_pop_view,
+    t_stack_concurrent_push_pop,
+    t_stack_concurrent_threads,
+    t_stack_concurrent_elimination,
+    t_stack_concurrent_wait,
+    t_stack_work_stealing_push_pop_steal,
+    t_stack_work_stealing_threads,
+    t_stack_typed,
+    t_stack_try_errors,
+    t_stack_unsafe,
+    t_stack_mapped_reopen,
+    t_stack_save_load,
+    t_stack_sized_ops,
+    t_stack_fixed_buffer_options,
+    t_stack_persistent_fork,
+    t_stack_mark_rollback,
+    t_stack_at_foreach_find,
+    t_stack_indexed,
+    t_stack_variable_records,
+    t_stack_reserved,
+    t_stack_trim,
+    t_stack_init_in,
+#ifdef STACK_STATS
+    t_stack_stats,
+#endif
     t_stack_destroy_empty,
     t_stack_destroy_non_empty,
     t_stack_various_data_types,
@@ -0,0 +1,42 @@
+#ifndef __TRIM_H__
+#define __TRIM_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "stack.h"
+
+// Politique de trim automatique (voir stack_trim_policy_t), partagee par les piles a tableau.
+// Chaque pile garde un seuil calcule par stack_trim_threshold a chaque changement de capacite : le test dans pop
+// est une seule comparaison (le seuil vaut 0 si la politique est desactivee). Sous le seuil, la pile garde
+// stack_trim_keep unites et rend le reste.
+
+///@brief Verifie une politique et remplace headroom par sa valeur par defaut, retourne false si elle est invalide
+static inline bool stack_trim_policy_check(stack_trim_policy_t* policy){
+    if (policy->low_watermark == 0) return true;
+    if (policy->headroom == 0) policy->headroom = STACK_TRIM_DEFAULT_HEADROOM;
+
+    return policy->low_watermark > 0 && policy->low_watermark < 1
+        && policy->headroom >= 1 && policy->low_watermark * policy->headroom < 1;
+}
+
+///@brief Le nombre d'unites sous lequel un pop declenche un trim, pour une capacite de capacity unites de unit octets
+///@note Le seuil tient compte de min_bytes : sous le seuil, le trim rend toujours au moins min_bytes octets
+static inline size_t stack_trim_threshold(const stack_trim_policy_t* policy, size_t capacity, size_t unit){
+    if (policy->low_watermark == 0) return 0;
+
+    double below = (double)capacity * policy->low_watermark;
+    double spare = (double)capacity * unit - (double)policy->min_bytes;
+    if (spare <= 0) return 0;
+
+    double gain = spare / ((double)unit * policy->headroom);
+    return (size_t)(gain < below ? gain : below);
+}
+
+///@brief Le nombre d'unites gardees par un trim quand la pile en utilise count
+static inline size_t stack_trim_keep(const stack_trim_policy_t* policy, size_t count){
+    double keep = (double)count * policy->headroom;
+    return keep > (double)count ? (size_t)keep : count;
+}
+
+#endif // __TRIM_H__
@@ -0,0 +1,80 @@
+#ifndef __TSTACK_H__
+#define __TSTACK_H__
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "stack.h"
+
+// Piles typees generees a la compilation, sans vtable ni memcpy de taille variable.
+//
+// STACK_DEFINE(name, T) genere des fonctions static inline name_push, name_pop, name_peek,
+// name_is_empty et name_create qui travaillent directement sur le tableau d'une pile contigue
+// (STACK_TYPE_FIXED ou STACK_TYPE_GROWABLE). La pile reste un stack_t ordinaire : elle se cree,
+// se detruit et s'utilise aussi avec l'API generique (stack_push, stack_pop_n, ...).
+//
+// Seul le cas ou le tableau est plein passe par la vtable (agrandissement ou STACK_ERR_FULL, sans message).
+// La politique de trim automatique (stack_trim_policy_t) ne s'applique qu'aux operations de l'API generique.
+// Avec -DSTACK_STATS, push et pop passent par la vtable pour que les compteurs restent exacts.
+//
+// L'en-tete ne depend que de stack.h : make lib l'installe a cote de libstack.h (../libtstack.h).
+
+// Les premiers champs de fstack_t et gstack_t, communs aux deux piles (verifie dans stack.c)
+typedef struct _tstack_layout_t{
+    stack_t base;
+    void *data;
+    size_t top;
+    size_t length;
+    size_t high_water;
+} tstack_layout_t;
+
+#ifdef STACK_STATS
+#define TSTACK_STATS 1
+#else
+#define TSTACK_STATS 0
+#endif
+
+#define TSTACK_CHECK(stack, T) \
+    assert((stack) && ((stack)->type == STACK_TYPE_FIXED || (stack)->type == STACK_TYPE_GROWABLE) && (stack)->size == sizeof(T))
+
+#define STACK_DEFINE(name, T)                                                               \
+                                                                                            \
+    /* Cree une pile contigue de T (STACK_TYPE_FIXED ou STACK_TYPE_GROWABLE) */             \
+    static inline stack_t* name##_create(stack_type_t type, size_t length){                 \
+        if (type == STACK_TYPE_GROWABLE)                                                    \
+            return stack_create(type, &(gstack_config_t){.size = sizeof(T), .initial_length = length}); \
+        return stack_create(type, &(fstack_config_t){.size = sizeof(T), .length = length}); \
+    }                                                                                       \
+                                                                                            \
+    static inline int name##_push(stack_t* stack, T val){                                   \
+        TSTACK_CHECK(stack, T);                                                             \
+        tstack_layout_t *s = (tstack_layout_t*)stack;                                       \
+        if (TSTACK_STATS || s->top == s->length) return stack->push(stack, &val);           \
+        ((T*)s->data)[s->top++] = val;                                                      \
+        if (s->top > s->high_water) s->high_water = s->top;                                 \
+        return 0;                                                                           \
+    }                                                                                       \
+                                                                                            \
+    static inline bool name##_pop(stack_t* stack, T* popped){                               \
+        TSTACK_CHECK(stack, T);                                                             \
+        tstack_layout_t *s = (tstack_layout_t*)stack;                                       \
+        if (s->top == 0) return false;                                                      \
+        if (TSTACK_STATS) return stack->pop(stack, popped) == STACK_OK;                     \
+        s->top--;                                                                           \
+        if (popped) *popped = ((T*)s->data)[s->top];                                        \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    static inline T* name##_peek(stack_t* stack){                                           \
+        TSTACK_CHECK(stack, T);                                                             \
+        tstack_layout_t *s = (tstack_layout_t*)stack;                                       \
+        return s->top ? &((T*)s->data)[s->top - 1] : NULL;                                  \
+    }                                                                                       \
+                                                                                            \
+    static inline bool name##_is_empty(stack_t* stack){                                     \
+        TSTACK_CHECK(stack, T);                                                             \
+        return ((tstack_layout_t*)stack)->top == 0;                                         \
+    }
+
+#endif // __TSTACK_H__
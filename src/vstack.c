@@ -0,0 +1,435 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "stack.h"
+#include "vstack.h"
+#include "alloc.h"
+#include "stats.h"
+#include "trim.h"
+
+static void vstack_destroy(stack_t** stack_ptr);
+static stack_error_t vstack_push(stack_t* stack, void* val);
+static void* vstack_peek(stack_t* stack);
+static stack_error_t vstack_pop(stack_t* stack, void* popped);
+static bool vstack_is_empty(stack_t* stack);
+static size_t vstack_pop_n(stack_t* stack, void* out, size_t n, stack_order_t order);
+static void* vstack_pop_view(stack_t* stack);
+static size_t vstack_count(stack_t* stack);
+static stack_error_t vstack_save(stack_t* stack, FILE* file);
+static stack_error_t vstack_load(stack_t* stack, FILE* file, size_t count);
+static void vstack_truncate(stack_t* stack, size_t count);
+static void* vstack_at(stack_t* stack, size_t depth);
+static stack_error_t vstack_foreach(stack_t* stack, stack_order_t order, stack_visitor_t visit, void* ctx);
+static void* vstack_emplace_record(stack_t* stack, size_t len, stack_error_t* err);
+static void* vstack_peek_record(stack_t* stack, size_t* len);
+static void* vstack_pop_record_view(stack_t* stack, size_t* len);
+static stack_error_t vstack_push_records(stack_t* stack, const void* data, const size_t* lens, size_t n);
+static size_t vstack_shrink(stack_t* stack);
+
+int vstack_init(vstack_t* stack, vstack_config_t config){
+    if (!stack) return (fprintf(stderr, "[!] vstack_init : invalid stack pointer\n"), -1);
+
+    size_t alignment = config.alignment ? config.alignment : sizeof(size_t);
+    if (alignment & (alignment - 1)) return (fprintf(stderr, "[!] vstack_init : invalid config alignment : alignment must be a power of 2\n"), -1);
+    if (alignment < sizeof(size_t) || alignment > _Alignof(max_align_t))
+        return (fprintf(stderr, "[!] vstack_init : invalid config alignment : alignment must be between %zu and %zu\n",
+                        sizeof(size_t), (size_t)_Alignof(max_align_t)), -1);
+    if (!stack_trim_policy_check(&config.trim)) return (fprintf(stderr, "[!] vstack_init : invalid config trim : low_watermark must be in [0, 1[ and low_watermark * headroom < 1\n"), -1);
+
+    size_t initial_bytes = config.initial_bytes ? config.initial_bytes : VSTACK_DEFAULT_INITIAL_BYTES;
+
+    memset(stack, 0, sizeof(*stack));
+
+    stack->base = (stack_t){
+        .type = STACK_TYPE_VARIABLE,
+        .size = 0,
+        .allocator = config.allocator,
+        .destroy = vstack_destroy,
+        .push = vstack_push,
+        .peek = vstack_peek,
+        .pop = vstack_pop,
+        .is_empty = vstack_is_empty,
+        .pop_n = vstack_pop_n,
+        .pop_view = vstack_pop_view,
+        .count = vstack_count,
+        .save = vstack_save,
+        .load = vstack_load,
+        .truncate = vstack_truncate,
+        .at = vstack_at,
+        .foreach = vstack_foreach,
+        .emplace_record = vstack_emplace_record,
+        .peek_record = vstack_peek_record,
+        .pop_record_view = vstack_pop_record_view,
+        .push_records = vstack_push_records,
+        .shrink = vstack_shrink
+    };
+
+    stack->data = stack_mem_alloc(config.allocator, initial_bytes);
+    if (!stack->data) return (perror("malloc failed"), -1);
+    STACK_STATS_ALLOC(stack, initial_bytes);
+
+    stack->top = 0;
+    stack->capacity = initial_bytes;
+    stack->count = 0;
+    stack->alignment = alignment;
+    stack->trim = config.trim;
+    stack->trim_below = stack_trim_threshold(&config.trim, initial_bytes, 1);
+
+    return 0;
+}
+
+static void vstack_destroy(stack_t** stack_ptr){
+    assert(stack_ptr && *stack_ptr);
+    vstack_t *stack = (vstack_t*)*stack_ptr;
+
+    stack_mem_free(stack->base.allocator, stack->data);
+    stack_mem_free(stack->base.allocator, stack);
+    *stack_ptr = NULL;
+}
+
+//Retourne le nombre d'octets occupes par un enregistrement de len octets (0 si il depasse SIZE_MAX)
+static size_t vstack_record_bytes(vstack_t* vstack, size_t len){
+    if (len > SIZE_MAX - sizeof(size_t) - vstack->alignment) return 0;
+    return VSTACK_RECORD_BYTES(len, vstack->alignment);
+}
+
+//Retourne la longueur de l'enregistrement qui se termine a l'octet end
+static inline size_t vstack_len_before(vstack_t* vstack, size_t end){
+    size_t len;
+    memcpy(&len, vstack->data + end - sizeof(size_t), sizeof(size_t));
+    return len;
+}
+
+//Agrandit le tableau (en doublant sa taille) pour qu'il contienne au moins needed octets
+static stack_error_t vstack_reserve(vstack_t* vstack, size_t needed){
+    if (needed <= vstack->capacity) return STACK_OK;
+
+    size_t capacity = vstack->capacity ? vstack->capacity : 1;
+    while (capacity < needed)
+        capacity = capacity > SIZE_MAX / 2 ? needed : capacity * 2;
+
+    char *data = stack_mem_realloc(vstack->base.allocator, vstack->data, capacity);
+    if (!data){
+        STACK_STATS_PUSH_FAILED(vstack);
+        return STACK_ERR_NO_MEMORY;
+    }
+
+    STACK_STATS_ALLOC(vstack, capacity - vstack->capacity);
+    vstack->data = data;
+    vstack->capacity = capacity;
+    vstack->trim_below = stack_trim_threshold(&vstack->trim, capacity, 1);
+
+    return STACK_OK;
+}
+
+//Reduit le tableau a keep octets (au moins top, arrondi a alignment), retourne le nombre d'octets rendus
+static size_t vstack_resize_down(vstack_t* vstack, size_t keep){
+    if (keep < vstack->top) keep = vstack->top;
+    keep = (keep + vstack->alignment - 1) & ~(vstack->alignment - 1);
+    if (keep == 0) keep = vstack->alignment;
+    if (keep >= vstack->capacity) return 0;
+
+    //un realloc qui echoue laisse le tableau intact : la pile reste utilisable, rien n'est rendu
+    char *data = stack_mem_realloc(vstack->base.allocator, vstack->data, keep);
+    if (!data) return 0;
+
+    size_t bytes = vstack->capacity - keep;
+    STACK_STATS_FREE(vstack, bytes);
+    STACK_STATS_TRIM(vstack, bytes);
+
+    vstack->data = data;
+    vstack->capacity = keep;
+    vstack->trim_below = stack_trim_threshold(&vstack->trim, keep, 1);
+
+    return bytes;
+}
+
+//Applique la politique de trim apres un retrait (jamais apres pop_view : l'enregistrement retire doit rester lisible)
+static inline void vstack_auto_trim(vstack_t* vstack){
+    if (vstack->top < vstack->trim_below)
+        vstack_resize_down(vstack, stack_trim_keep(&vstack->trim, vstack->top));
+}
+
+//Reserve un enregistrement de len octets au sommet et ecrit sa longueur, le contenu reste a remplir
+static void* vstack_emplace_record(stack_t* stack, size_t len, stack_error_t* err){
+    assert(stack && err);
+
+    vstack_t *vstack = (vstack_t*)stack;
+    size_t bytes = vstack_record_bytes(vstack, len);
+
+    //len ne tient pas dans l'espace adressable : la pile est pleine, ce n'est pas un manque de memoire
+    if (bytes == 0 || bytes > SIZE_MAX - vstack->top){
+        STACK_STATS_PUSH_FAILED(stack);
+        *err = STACK_ERR_FULL;
+        return NULL;
+    }
+
+    *err = vstack_reserve(vstack, vstack->top + bytes);
+    if (*err != STACK_OK) return NULL;
+
+    char *record = vstack->data + vstack->top;
+    memcpy(record + bytes - sizeof(size_t), &len, sizeof(size_t));
+
+    vstack->top += bytes;
+    vstack->count++;
+    STACK_STATS_PUSH(stack, 1);
+
+    return record;
+}
+
+//Les enregistrements n'ont pas de taille fixe : il faut passer par stack_push_record
+static stack_error_t vstack_push(stack_t* stack, void* val){
+    assert(stack);
+    (void)stack;
+    (void)val;
+    return STACK_ERR_UNSUPPORTED;
+}
+
+static void* vstack_peek_record(stack_t* stack, size_t* len){
+    assert(stack);
+
+    vstack_t *vstack = (vstack_t*)stack;
+    if (vstack->count == 0) return NULL;
+
+    size_t record_len = vstack_len_before(vstack, vstack->top);
+    if (len) *len = record_len;
+
+    return vstack->data + vstack->top - VSTACK_RECORD_BYTES(record_len, vstack->alignment);
+}
+
+static void* vstack_peek(stack_t* stack){
+    return vstack_peek_record(stack, NULL);
+}
+
+//L'enregistrement reste en place dans le tableau jusqu'au prochain push
+static void* vstack_pop_record_view(stack_t* stack, size_t* len){
+    assert(stack);
+
+    vstack_t *vstack = (vstack_t*)stack;
+    if (vstack->count == 0) return NULL;
+
+    size_t record_len = vstack_len_before(vstack, vstack->top);
+    if (len) *len = record_len;
+
+    vstack->top -= VSTACK_RECORD_BYTES(record_len, vstack->alignment);
+    vstack->count--;
+    STACK_STATS_POP(stack, 1);
+
+    return vstack->data + vstack->top;
+}
+
+static void* vstack_pop_view(stack_t* stack){
+    return vstack_pop_record_view(stack, NULL);
+}
+
+//Copie l'enregistrement entier dans popped (voir stack_pop_record pour une copie bornee)
+//La taille du tampon de stack_pop n'est pas connue : seul le retrait sans copie est supporte (voir stack_pop_record)
+static stack_error_t vstack_pop(stack_t* stack, void* popped){
+    if (popped) return STACK_ERR_UNSUPPORTED;
+    if (!vstack_pop_record_view(stack, NULL)) return STACK_ERR_EMPTY;
+
+    vstack_auto_trim((vstack_t*)stack);
+    return STACK_OK;
+}
+
+static bool vstack_is_empty(stack_t* stack){
+    assert(stack);
+    return ((vstack_t*)stack)->count == 0;
+}
+
+//data contient les n enregistrements les uns apres les autres : une seule reservation pour tout le lot
+static stack_error_t vstack_push_records(stack_t* stack, const void* data, const size_t* lens, size_t n){
+    assert(stack && (n == 0 || (data && lens)));
+
+    vstack_t *vstack = (vstack_t*)stack;
+    size_t total = 0;
+
+    for (size_t i = 0; i < n; i++){
+        size_t bytes = vstack_record_bytes(vstack, lens[i]);
+        if (bytes == 0 || bytes > SIZE_MAX - vstack->top - total){
+            STACK_STATS_PUSH_FAILED(stack);
+            return STACK_ERR_FULL;
+        }
+        total += bytes;
+    }
+
+    stack_error_t err = vstack_reserve(vstack, vstack->top + total);
+    if (err) return err;
+
+    const char *src = data;
+    for (size_t i = 0; i < n; i++){
+        char *record = vstack->data + vstack->top;
+        size_t bytes = VSTACK_RECORD_BYTES(lens[i], vstack->alignment);
+
+        memcpy(record, src, lens[i]);
+        memcpy(record + bytes - sizeof(size_t), &lens[i], sizeof(size_t));
+
+        vstack->top += bytes;
+        src += lens[i];
+    }
+
+    vstack->count += n;
+    STACK_STATS_PUSH(stack, n);
+
+    return STACK_OK;
+}
+
+//out recoit les enregistrements les uns apres les autres, sans leur longueur
+//(en ordre BOTTOM_UP, une premiere passe calcule leur taille totale pour remplir out depuis la fin)
+//Retire n enregistrements sans les copier (stack_pop_n refuse out pour une pile sans taille d'element)
+static size_t vstack_pop_n(stack_t* stack, void* out, size_t n, stack_order_t order){
+    assert(stack);
+    (void)order;
+    if (out) return 0;
+
+    vstack_t *vstack = (vstack_t*)stack;
+    size_t k = n < vstack->count ? n : vstack->count;
+    size_t end = vstack->top;
+
+    for (size_t i = 0; i < k; i++)
+        end -= VSTACK_RECORD_BYTES(vstack_len_before(vstack, end), vstack->alignment);
+
+    vstack->top = end;
+    vstack->count -= k;
+    STACK_STATS_POP(stack, k);
+
+    vstack_auto_trim(vstack);
+    return k;
+}
+
+static size_t vstack_count(stack_t* stack){
+    assert(stack);
+    return ((vstack_t*)stack)->count;
+}
+
+//Les longueurs sont a la fin des enregistrements : on recule d'enregistrement en enregistrement, en O(count - mark)
+static void vstack_truncate(stack_t* stack, size_t count){
+    assert(stack);
+
+    vstack_t *vstack = (vstack_t*)stack;
+    assert(count <= vstack->count);
+
+    STACK_STATS_POP(stack, vstack->count - count);
+
+    while (vstack->count > count){
+        vstack->top -= VSTACK_RECORD_BYTES(vstack_len_before(vstack, vstack->top), vstack->alignment);
+        vstack->count--;
+    }
+
+    vstack_auto_trim(vstack);
+}
+
+static size_t vstack_shrink(stack_t* stack){
+    assert(stack);
+    return vstack_resize_down((vstack_t*)stack, 0);
+}
+
+static void* vstack_at(stack_t* stack, size_t depth){
+    assert(stack);
+
+    vstack_t *vstack = (vstack_t*)stack;
+    if (depth >= vstack->count) return NULL;
+
+    size_t end = vstack->top;
+    for (;;){
+        size_t bytes = VSTACK_RECORD_BYTES(vstack_len_before(vstack, end), vstack->alignment);
+        if (depth-- == 0) return vstack->data + end - bytes;
+        end -= bytes;
+    }
+}
+
+//Retourne la fin de chaque enregistrement, du fond vers le sommet (tableau a liberer)
+static size_t* vstack_record_ends(vstack_t* vstack){
+    if (vstack->count > SIZE_MAX / sizeof(size_t)) return NULL;
+
+    size_t *ends = stack_mem_alloc(vstack->base.allocator, vstack->count * sizeof(size_t));
+    if (!ends) return NULL;
+
+    size_t end = vstack->top;
+    for (size_t i = vstack->count; i > 0; i--){
+        ends[i - 1] = end;
+        end -= VSTACK_RECORD_BYTES(vstack_len_before(vstack, end), vstack->alignment);
+    }
+
+    return ends;
+}
+
+//Du fond vers le sommet, on releve d'abord la fin de chaque enregistrement (on ne peut remonter qu'a partir du sommet)
+static stack_error_t vstack_foreach(stack_t* stack, stack_order_t order, stack_visitor_t visit, void* ctx){
+    assert(stack && visit);
+
+    vstack_t *vstack = (vstack_t*)stack;
+
+    if (order == STACK_ORDER_TOP_DOWN){
+        size_t end = vstack->top;
+        for (size_t i = 0; i < vstack->count; i++){
+            end -= VSTACK_RECORD_BYTES(vstack_len_before(vstack, end), vstack->alignment);
+            if (!visit(vstack->data + end, ctx)) break;
+        }
+        return STACK_OK;
+    }
+
+    if (vstack->count == 0) return STACK_OK;
+
+    size_t *ends = vstack_record_ends(vstack);
+    if (!ends) return STACK_ERR_NO_MEMORY;
+
+    for (size_t i = 0; i < vstack->count; i++)
+        if (!visit(vstack->data + (i ? ends[i - 1] : 0), ctx)) break;
+
+    stack_mem_free(stack->allocator, ends);
+    return STACK_OK;
+}
+
+//Chaque enregistrement est ecrit sous la forme (longueur sur 64 bits, octets), du fond vers le sommet,
+//pour pouvoir etre relu avec un autre alignement
+static stack_error_t vstack_save(stack_t* stack, FILE* file){
+    assert(stack && file);
+
+    vstack_t *vstack = (vstack_t*)stack;
+    if (vstack->count == 0) return STACK_OK;
+
+    size_t *ends = vstack_record_ends(vstack);
+    if (!ends) return STACK_ERR_NO_MEMORY;
+
+    stack_error_t err = STACK_OK;
+    for (size_t i = 0; i < vstack->count && !err; i++){
+        size_t len = vstack_len_before(vstack, ends[i]);
+        uint64_t len64 = len;
+
+        if (fwrite(&len64, sizeof(len64), 1, file) != 1 || fwrite(vstack->data + (i ? ends[i - 1] : 0), 1, len, file) != len)
+            err = STACK_ERR_IO;
+    }
+
+    stack_mem_free(stack->allocator, ends);
+    return err;
+}
+
+//Chaque enregistrement est lu directement a sa place, un enregistrement incomplet est retire
+static stack_error_t vstack_load(stack_t* stack, FILE* file, size_t count){
+    assert(stack && file);
+
+    vstack_t *vstack = (vstack_t*)stack;
+
+    for (size_t i = 0; i < count; i++){
+        uint64_t len64;
+        if (fread(&len64, sizeof(len64), 1, file) != 1) return STACK_ERR_IO;
+        if (len64 > SIZE_MAX) return STACK_ERR_IO;
+
+        size_t len = (size_t)len64;
+        stack_error_t err = STACK_OK;
+        void *record = vstack_emplace_record(stack, len, &err);
+        if (!record) return err;
+
+        if (fread(record, 1, len, file) != len){
+            vstack_truncate(stack, vstack->count - 1);
+            return STACK_ERR_IO;
+        }
+    }
+
+    return STACK_OK;
+}
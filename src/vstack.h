@@ -0,0 +1,31 @@
+#ifndef __VSTACK_H__
+#define __VSTACK_H__
+
+#include "stack.h"
+
+// Les enregistrements sont ranges les uns apres les autres dans data : chaque enregistrement occupe
+// VSTACK_RECORD_BYTES(len, alignment) octets, ses len octets au debut et sa longueur (size_t) a la fin,
+// pour que pop retrouve le debut de l'enregistrement precedent
+///@param data: Le tableau des enregistrements
+///@param top: Le nombre d'octets utilises (la fin de l'enregistrement au sommet)
+///@param capacity: La taille du tableau en octets
+///@param count: Le nombre d'enregistrements
+///@param alignment: L'alignement du debut de chaque enregistrement
+///@param trim: La politique de trim automatique (en octets)
+///@param trim_below: Un pop qui fait passer top sous trim_below octets reduit le tableau (0 = jamais)
+typedef struct _vstack_t{
+    stack_t base;
+    char *data;
+    size_t top;
+    size_t capacity;
+    size_t count;
+    size_t alignment;
+    stack_trim_policy_t trim;
+    size_t trim_below;
+} vstack_t;
+
+#define VSTACK_RECORD_BYTES(len, alignment) (((len) + sizeof(size_t) + (alignment) - 1) & ~((alignment) - 1))
+
+int vstack_init(vstack_t* stack, vstack_config_t config);
+
+#endif // __VSTACK_H__
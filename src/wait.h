@@ -0,0 +1,79 @@
+#ifndef __WAIT_H__
+#define __WAIT_H__
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include <time.h>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#else
+#include <sched.h>
+#endif
+
+// Attente d'un changement de valeur d'un mot de 32 bits (futex sous Linux)
+// Le mot est un compteur de sequence : celui qui attend lit sa valeur, verifie sa condition, puis s'endort
+// tant que le mot a toujours cette valeur. Celui qui reveille incremente le mot avant d'appeler stack_futex_wake,
+// un reveil entre la lecture et l'endormissement n'est donc jamais perdu.
+// Hors de Linux, l'attente se contente de rendre la main (sched_yield) : correcte mais active.
+
+///@brief Calcule l'echeance d'une attente de timeout_ms millisecondes (horloge monotone)
+static inline struct timespec stack_wait_deadline(long timeout_ms){
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L){
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    return deadline;
+}
+
+///@brief Endort le thread tant que *word vaut expected, jusqu'a deadline (NULL = sans limite)
+///@return false si l'echeance est depassee, true sinon (reveil, valeur deja changee ou reveil intempestif)
+static inline bool stack_futex_wait(_Atomic uint32_t* word, uint32_t expected, const struct timespec* deadline){
+    struct timespec remaining, *timeout = NULL;
+
+    if (deadline){
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        remaining.tv_sec = deadline->tv_sec - now.tv_sec;
+        remaining.tv_nsec = deadline->tv_nsec - now.tv_nsec;
+        if (remaining.tv_nsec < 0){
+            remaining.tv_sec--;
+            remaining.tv_nsec += 1000000000L;
+        }
+        if (remaining.tv_sec < 0) return false;
+        timeout = &remaining;
+    }
+
+#if defined(__linux__)
+    if (syscall(SYS_futex, (uint32_t*)word, FUTEX_WAIT_PRIVATE, expected, timeout, NULL, 0) == -1 && errno == ETIMEDOUT)
+        return false;
+#else
+    (void)word; (void)expected; (void)timeout;
+    sched_yield();
+#endif
+
+    return true;
+}
+
+///@brief Reveille au plus count threads endormis sur word (INT_MAX = tous)
+static inline void stack_futex_wake(_Atomic uint32_t* word, int count){
+#if defined(__linux__)
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+#else
+    (void)word; (void)count;
+#endif
+}
+
+#endif // __WAIT_H__
@@ -0,0 +1,246 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "stack.h"
+#include "wstack.h"
+#include "alloc.h"
+#include "stats.h"
+
+// Deque de Chase-Lev, version C11 de "Correct and Efficient Work-Stealing for Weak Memory Models"
+// (Le, Pop, Cohen, Zappa Nardelli). Le proprietaire n'utilise de CAS que pour le dernier element,
+// les voleurs font un CAS sur top.
+//
+// Un voleur peut lire une case pendant que le proprietaire la reecrit, si un autre voleur a deja avance top :
+// son CAS echoue alors et la copie est ignoree. Pour que ce ne soit pas une course au sens de C11, les cases
+// sont ecrites par push et lues par steal avec des acces atomiques relaxes, mot par mot si la taille des
+// elements le permet (les cases sont alors alignees sur 8 octets), octet par octet sinon. Cote appelant,
+// chaque mot passe par memcpy : val et stolen n'ont pas d'alignement garanti.
+
+static void wstack_destroy(stack_t** stack_ptr);
+static stack_error_t wstack_push(stack_t* stack, void* val);
+static void* wstack_peek(stack_t* stack);
+static stack_error_t wstack_pop(stack_t* stack, void* popped);
+static bool wstack_is_empty(stack_t* stack);
+static void* wstack_steal(stack_t* stack, void* stolen);
+
+static wbuffer_t* wbuffer_create(const stack_allocator_t* allocator, size_t length, size_t size){
+    if (length > (SIZE_MAX - sizeof(wbuffer_t)) / size) return NULL;
+
+    wbuffer_t *buffer = stack_mem_alloc(allocator, sizeof(wbuffer_t) + length * size);
+    if (!buffer) return NULL;
+
+    buffer->mask = length - 1;
+    buffer->prev = NULL;
+    return buffer;
+}
+
+static void* wbuffer_at(wbuffer_t* buffer, int64_t index, size_t size){
+    return buffer->data + ((size_t)index & buffer->mask) * size;
+}
+
+//Ecrit une case lisible en meme temps par un voleur
+static void wbuffer_store(void* slot, const void* val, size_t size){
+    if (size % sizeof(uint64_t) == 0){
+        _Atomic uint64_t *dst = slot;
+        for (size_t i = 0; i < size / sizeof(uint64_t); i++){
+            uint64_t word;
+            memcpy(&word, (const char*)val + i * sizeof(uint64_t), sizeof(uint64_t));
+            atomic_store_explicit(&dst[i], word, memory_order_relaxed);
+        }
+        return;
+    }
+
+    _Atomic unsigned char *dst = slot;
+    const unsigned char *src = val;
+    for (size_t i = 0; i < size; i++)
+        atomic_store_explicit(&dst[i], src[i], memory_order_relaxed);
+}
+
+//Lit une case que le proprietaire peut etre en train de reecrire
+static void wbuffer_load(void* val, void* slot, size_t size){
+    if (size % sizeof(uint64_t) == 0){
+        _Atomic uint64_t *src = slot;
+        for (size_t i = 0; i < size / sizeof(uint64_t); i++){
+            uint64_t word = atomic_load_explicit(&src[i], memory_order_relaxed);
+            memcpy((char*)val + i * sizeof(uint64_t), &word, sizeof(uint64_t));
+        }
+        return;
+    }
+
+    _Atomic unsigned char *src = slot;
+    unsigned char *dst = val;
+    for (size_t i = 0; i < size; i++)
+        dst[i] = atomic_load_explicit(&src[i], memory_order_relaxed);
+}
+
+int wstack_init(wstack_t* stack, wstack_config_t config){
+    if (!stack) return (fprintf(stderr, "[!] wstack_init : invalid stack pointer\n"), -1);
+    if (config.size == 0) return (fprintf(stderr, "[!] wstack_init : invalid config size : size must be > 0\n"), -1);
+
+    size_t length = 1;
+    size_t wanted = config.initial_length ? config.initial_length : WSTACK_DEFAULT_INITIAL_LENGTH;
+    while (length < wanted && length < SIZE_MAX / 2) length <<= 1;
+
+    memset(stack, 0, sizeof(*stack));
+
+    stack->base = (stack_t){
+        .type = STACK_TYPE_WORK_STEALING,
+        .size = config.size,
+        .allocator = config.allocator,
+        .destroy = wstack_destroy,
+        .push = wstack_push,
+        .peek = wstack_peek,
+        .pop = wstack_pop,
+        .is_empty = wstack_is_empty,
+        .steal = wstack_steal
+    };
+
+    wbuffer_t *buffer = wbuffer_create(config.allocator, length, config.size);
+    if (!buffer) return (perror("malloc failed"), -1);
+    STACK_STATS_ALLOC(stack, sizeof(wbuffer_t) + length * config.size);
+
+    atomic_init(&stack->top, 0);
+    atomic_init(&stack->bottom, 0);
+    atomic_init(&stack->buffer, buffer);
+
+    return 0;
+}
+
+static void wstack_destroy(stack_t** stack_ptr){
+    assert(stack_ptr && *stack_ptr);
+    wstack_t *stack = (wstack_t*)*stack_ptr;
+
+    wbuffer_t *buffer = atomic_load_explicit(&stack->buffer, memory_order_relaxed);
+    while (buffer){
+        wbuffer_t *tmp = buffer;
+        buffer = buffer->prev;
+        stack_mem_free(stack->base.allocator, tmp);
+    }
+
+    stack_mem_free(stack->base.allocator, stack);
+    *stack_ptr = NULL;
+}
+
+//Double le tableau et copie les elements [top, bottom[, l'ancien tableau reste lisible par les voleurs
+static wbuffer_t* wstack_grow(wstack_t* wstack, wbuffer_t* old, int64_t top, int64_t bottom){
+    size_t size = wstack->base.size;
+    size_t length = (old->mask + 1) * 2;
+
+    wbuffer_t *buffer = length > old->mask + 1 ? wbuffer_create(wstack->base.allocator, length, size) : NULL;
+    if (!buffer) return NULL;
+    STACK_STATS_ALLOC(wstack, sizeof(wbuffer_t) + length * size);
+
+    for (int64_t i = top; i < bottom; i++)
+        memcpy(wbuffer_at(buffer, i, size), wbuffer_at(old, i, size), size);
+
+    buffer->prev = old;
+    atomic_store_explicit(&wstack->buffer, buffer, memory_order_release);
+
+    return buffer;
+}
+
+static stack_error_t wstack_push(stack_t* stack, void* val){
+    assert(stack && val);
+
+    wstack_t *wstack = (wstack_t*)stack;
+
+    int64_t bottom = atomic_load_explicit(&wstack->bottom, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&wstack->top, memory_order_acquire);
+    wbuffer_t *buffer = atomic_load_explicit(&wstack->buffer, memory_order_relaxed);
+
+    if ((size_t)(bottom - top) > buffer->mask){
+        buffer = wstack_grow(wstack, buffer, top, bottom);
+        if (!buffer){
+            STACK_STATS_PUSH_FAILED(stack);
+            return STACK_ERR_NO_MEMORY;
+        }
+    }
+
+    wbuffer_store(wbuffer_at(buffer, bottom, stack->size), val, stack->size);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&wstack->bottom, bottom + 1, memory_order_relaxed);
+    STACK_STATS_PUSH(stack, 1);
+
+    return STACK_OK;
+}
+
+static void* wstack_peek(stack_t* stack){
+    assert(stack);
+
+    wstack_t *wstack = (wstack_t*)stack;
+
+    int64_t bottom = atomic_load_explicit(&wstack->bottom, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&wstack->top, memory_order_acquire);
+    if (bottom <= top) return NULL;
+
+    wbuffer_t *buffer = atomic_load_explicit(&wstack->buffer, memory_order_relaxed);
+    return wbuffer_at(buffer, bottom - 1, stack->size);
+}
+
+static stack_error_t wstack_pop(stack_t* stack, void* popped){
+    assert(stack);
+
+    wstack_t *wstack = (wstack_t*)stack;
+
+    int64_t bottom = atomic_load_explicit(&wstack->bottom, memory_order_relaxed) - 1;
+    wbuffer_t *buffer = atomic_load_explicit(&wstack->buffer, memory_order_relaxed);
+    atomic_store_explicit(&wstack->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(&wstack->top, memory_order_relaxed);
+
+    if (top > bottom){
+        //pile vide
+        atomic_store_explicit(&wstack->bottom, bottom + 1, memory_order_relaxed);
+        return STACK_ERR_EMPTY;
+    }
+
+    void *res = wbuffer_at(buffer, bottom, stack->size);
+
+    if (top == bottom){
+        //dernier element : on le dispute aux voleurs, perdre revient a trouver la pile vide
+        bool won = atomic_compare_exchange_strong_explicit(&wstack->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&wstack->bottom, bottom + 1, memory_order_relaxed);
+        if (!won) return STACK_ERR_EMPTY;
+    }
+
+    if (popped)
+        memcpy(popped, res, stack->size);
+
+    STACK_STATS_POP(stack, 1);
+    return STACK_OK;
+}
+
+static bool wstack_is_empty(stack_t* stack){
+    assert(stack);
+
+    wstack_t *wstack = (wstack_t*)stack;
+    int64_t top = atomic_load_explicit(&wstack->top, memory_order_acquire);
+    int64_t bottom = atomic_load_explicit(&wstack->bottom, memory_order_acquire);
+
+    return bottom <= top;
+}
+
+static void* wstack_steal(stack_t* stack, void* stolen){
+    assert(stack && stolen);
+
+    wstack_t *wstack = (wstack_t*)stack;
+
+    int64_t top = atomic_load_explicit(&wstack->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t bottom = atomic_load_explicit(&wstack->bottom, memory_order_acquire);
+
+    if (top >= bottom) return NULL;
+
+    wbuffer_t *buffer = atomic_load_explicit(&wstack->buffer, memory_order_acquire);
+    wbuffer_load(stolen, wbuffer_at(buffer, top, stack->size), stack->size);
+
+    if (!atomic_compare_exchange_strong_explicit(&wstack->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+        return NULL;
+
+    STACK_STATS_POP(stack, 1);
+    return stolen;
+}
@@ -0,0 +1,32 @@
+#ifndef __WSTACK_H__
+#define __WSTACK_H__
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "stack.h"
+
+// Un tableau circulaire de mask + 1 elements, prev est le tableau qu'il remplace (garde pour les voleurs)
+typedef struct _wbuffer_t{
+    size_t mask;
+    struct _wbuffer_t *prev;
+    _Alignas(max_align_t) char data[];
+} wbuffer_t;
+
+// Deque de Chase-Lev : le proprietaire ajoute et retire a bottom (le sommet de la pile),
+// les voleurs retirent a top (le fond de la pile). Les elements sont dans [top, bottom[
+///@param top: L'index de l'element le plus ancien
+///@param bottom: L'index de la prochaine case libre
+///@param buffer: Le tableau courant
+// top et bottom sont sur des lignes de cache differentes (ecrits par des threads differents)
+typedef struct _wstack_t{
+    stack_t base;
+    _Atomic int64_t top;
+    char padding[64 - sizeof(int64_t)];
+    _Atomic int64_t bottom;
+    _Atomic(wbuffer_t*) buffer;
+} wstack_t;
+
+int wstack_init(wstack_t* stack, wstack_config_t config);
+
+#endif // __WSTACK_H__